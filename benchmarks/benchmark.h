@@ -0,0 +1,267 @@
+#ifndef ATC_BENCHMARK_H
+#define ATC_BENCHMARK_H
+
+#include "common.h"
+
+#include <chrono>
+#include <random>
+#include <iomanip>
+
+#ifdef WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+
+namespace atc
+{
+	namespace benchmark
+	{
+		/**
+		 * Simple wall-clock timer for measuring benchmark runs.
+		 */
+		class Stopwatch
+		{
+		public:
+			typedef std::chrono::steady_clock Clock;
+
+			Stopwatch() :
+				m_start( Clock::now() )
+			{ }
+
+			void restart()
+			{
+				m_start = Clock::now();
+			}
+
+			double getElapsedNanoseconds() const
+			{
+				return std::chrono::duration< double, std::nano >( Clock::now() - m_start ).count();
+			}
+
+		protected:
+			Clock::time_point m_start;
+		};
+
+
+		/**
+		 * Returns the peak resident set size of this process so far (in bytes).
+		 */
+		inline size_t getPeakResidentSetSize()
+		{
+#ifdef WIN32
+			PROCESS_MEMORY_COUNTERS counters;
+			GetProcessMemoryInfo( GetCurrentProcess(), &counters, sizeof( counters ) );
+			return (size_t) counters.PeakWorkingSetSize;
+#else
+			struct rusage usage;
+			getrusage( RUSAGE_SELF, &usage );
+#ifdef __APPLE__
+			return (size_t) usage.ru_maxrss;
+#else
+			return (size_t) usage.ru_maxrss * 1024u;
+#endif
+#endif
+		}
+
+
+		/**
+		 * Returns the value at the given percentile (0 to 100) of a set of samples.
+		 */
+		inline double getPercentile( std::vector< double > samples, double percentile )
+		{
+			requires( !samples.empty() );
+			std::sort( samples.begin(), samples.end() );
+
+			size_t index = (size_t) ( ( percentile / 100.0 ) * ( samples.size() - 1 ) + 0.5 );
+			return samples[ std::min( index, samples.size() - 1 ) ];
+		}
+
+
+		/**
+		 * Returns whether this build was compiled with assertions enabled.
+		 */
+		inline bool assertionsAreEnabled()
+		{
+#ifdef NDEBUG
+			return false;
+#else
+			return true;
+#endif
+		}
+
+
+		// ------------------------------ Synthetic maps ------------------------------
+
+		/**
+		 * Resizes the Map and makes every tile passable.
+		 */
+		inline void generateOpenMap( Map* map, size_t width, size_t height )
+		{
+			map->resize( width, height );
+			map->clear();
+		}
+
+
+		/**
+		 * Fills the Map with a perfect maze of one-tile-wide corridors.
+		 */
+		inline void generateMazeMap( Map* map, size_t width, size_t height, unsigned int seed = 1 )
+		{
+			map->resize( width, height );
+			map->clear();
+
+			// Start with every tile blocked.
+			for( size_t y = 0; y < height; ++y )
+			{
+				for( size_t x = 0; x < width; ++x )
+				{
+					map->getTile( (Map::TileOffset) x, (Map::TileOffset) y )->setPassable( false );
+				}
+			}
+
+			// Carve corridors between the odd-numbered tiles with a randomized depth-first search.
+			std::mt19937 random( seed );
+			std::vector< Map::TileVector > stack;
+
+			Map::TileVector start( 1, 1 );
+			map->getTile( start )->setPassable( true );
+			stack.push_back( start );
+
+			const Map::TileVector steps[] =
+			{
+				Map::TileVector( 2, 0 ), Map::TileVector( -2, 0 ),
+				Map::TileVector( 0, 2 ), Map::TileVector( 0, -2 )
+			};
+
+			while( !stack.empty() )
+			{
+				Map::TileVector current = stack.back();
+				Map::TileVector candidates[ 4 ];
+				size_t candidateCount = 0;
+
+				for( size_t i = 0; i < 4; ++i )
+				{
+					// Find every unvisited cell two tiles away.
+					Map::TileVector next = ( current + steps[ i ] );
+
+					if( next.x > 0 && next.y > 0 && next.x < (Map::TileOffset) width - 1 && next.y < (Map::TileOffset) height - 1 &&
+						!map->getTile( next )->isPassable() )
+					{
+						candidates[ candidateCount++ ] = next;
+					}
+				}
+
+				if( candidateCount == 0 )
+				{
+					// Backtrack once this cell is a dead end.
+					stack.pop_back();
+					continue;
+				}
+
+				// Knock down the wall between this cell and a random neighbor.
+				Map::TileVector next = candidates[ random() % candidateCount ];
+				Map::TileVector wall( ( current.x + next.x ) / 2, ( current.y + next.y ) / 2 );
+
+				map->getTile( wall )->setPassable( true );
+				map->getTile( next )->setPassable( true );
+				stack.push_back( next );
+			}
+		}
+
+
+		/**
+		 * Divides the Map into square rooms, with a two-tile door in the middle of every wall.
+		 */
+		inline void generateRoomsMap( Map* map, size_t width, size_t height, size_t roomSize = 16 )
+		{
+			requires( roomSize >= 4 );
+
+			map->resize( width, height );
+			map->clear();
+
+			size_t doorOffset = ( roomSize / 2 );
+
+			for( size_t y = 0; y < height; ++y )
+			{
+				for( size_t x = 0; x < width; ++x )
+				{
+					bool isVerticalWall = ( ( x % roomSize ) == 0 );
+					bool isHorizontalWall = ( ( y % roomSize ) == 0 );
+					bool isVerticalDoor = ( isVerticalWall && !isHorizontalWall && ( ( y % roomSize ) == doorOffset || ( y % roomSize ) == doorOffset - 1 ) );
+					bool isHorizontalDoor = ( isHorizontalWall && !isVerticalWall && ( ( x % roomSize ) == doorOffset || ( x % roomSize ) == doorOffset - 1 ) );
+
+					if( ( isVerticalWall || isHorizontalWall ) && !isVerticalDoor && !isHorizontalDoor )
+					{
+						map->getTile( (Map::TileOffset) x, (Map::TileOffset) y )->setPassable( false );
+					}
+				}
+			}
+		}
+
+
+		/**
+		 * Covers the Map with patches of rough terrain of random cost, crossed by a grid of roads
+		 * that cost the least, so the shortest routes follow the roads.
+		 */
+		inline void generateRoadsMap( Map* map, size_t width, size_t height, size_t roadSpacing = 64, size_t patchSize = 8, unsigned int seed = 1 )
+		{
+			map->resize( width, height );
+			map->clear();
+
+			// Pick a cost for each patch of terrain.
+			std::mt19937 random( seed );
+			size_t patchesWide = ( ( width + patchSize - 1 ) / patchSize );
+			size_t patchesHigh = ( ( height + patchSize - 1 ) / patchSize );
+			std::vector< unsigned int > patchCosts( patchesWide * patchesHigh );
+
+			for( unsigned int& cost : patchCosts )
+			{
+				cost = ( MapTile::MIN_COST + 1 + ( random() % ( MapTile::MAX_COST - MapTile::MIN_COST ) ) );
+			}
+
+			for( size_t y = 0; y < height; ++y )
+			{
+				for( size_t x = 0; x < width; ++x )
+				{
+					bool isRoad = ( ( x % roadSpacing ) == ( roadSpacing / 2 ) || ( y % roadSpacing ) == ( roadSpacing / 2 ) );
+					unsigned int cost = ( isRoad ? MapTile::MIN_COST : patchCosts[ ( y / patchSize ) * patchesWide + ( x / patchSize ) ] );
+					map->getTile( (Map::TileOffset) x, (Map::TileOffset) y )->setTerrainCost( cost );
+				}
+			}
+		}
+
+
+		/**
+		 * Returns the passable tile closest to the center of the Map.
+		 */
+		inline Map::TileVector findCentralPassableTile( const Map* map )
+		{
+			Map::TileOffset centerX = (Map::TileOffset) ( map->getWidth() / 2 );
+			Map::TileOffset centerY = (Map::TileOffset) ( map->getHeight() / 2 );
+
+			Map::TileVector result( centerX, centerY );
+			int bestDistance = std::numeric_limits< int >::max();
+
+			for( Map::TileOffset y = 0; y < (Map::TileOffset) map->getHeight(); ++y )
+			{
+				for( Map::TileOffset x = 0; x < (Map::TileOffset) map->getWidth(); ++x )
+				{
+					int distance = ( abs( x - centerX ) + abs( y - centerY ) );
+
+					if( distance < bestDistance && map->getTile( x, y )->isPassable() )
+					{
+						result = Map::TileVector( x, y );
+						bestDistance = distance;
+					}
+				}
+			}
+
+			return result;
+		}
+	}
+}
+
+#endif
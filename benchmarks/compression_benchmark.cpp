@@ -0,0 +1,135 @@
+#include "benchmark.h"
+
+using namespace atc;
+using namespace atc::benchmark;
+
+
+namespace
+{
+	const int RUN_COUNT = 5;
+	const size_t LOOKUP_COUNT = 1000000;
+
+
+	/**
+	 * Compresses a flowfield toward the central tile of the Map, both cardinal and octile, and
+	 * reports the bytes per tile kept, the time to compress and expand it, and the time per
+	 * random lookup of a tile's flow in the compressed form.
+	 */
+	void runCases( Map* map, const std::string& name, size_t& checksum )
+	{
+		Map::TileVector goal = findCentralPassableTile( map );
+		size_t tileCount = ( map->getWidth() * map->getHeight() );
+
+		for( bool isOctile : { false, true } )
+		{
+			Flowfield* flowfield = map->createFlowfield();
+			flowfield->setGoalTile( flowfield->getTile( goal.x, goal.y ) );
+			flowfield->setOctile( isOctile );
+			flowfield->recalculate();
+
+			std::vector< double > compressSamples;
+			std::vector< double > decompressSamples;
+			bool isCompressed = true;
+			size_t compressedSize = 0;
+
+			for( int i = 0; i < RUN_COUNT && isCompressed; ++i )
+			{
+				Stopwatch stopwatch;
+				isCompressed = flowfield->compress();
+				compressSamples.push_back( stopwatch.getElapsedNanoseconds() );
+
+				if( isCompressed )
+				{
+					compressedSize = flowfield->getCompressedSize();
+					stopwatch.restart();
+					flowfield->decompress();
+					decompressSamples.push_back( stopwatch.getElapsedNanoseconds() );
+				}
+			}
+
+			std::cout << std::left << std::setw( 18 ) << name
+					  << std::setw( 9 ) << ( isOctile ? "octile" : "cardinal" );
+
+			if( isCompressed )
+			{
+				// Look up random tiles, as Units spread over the map would.
+				std::mt19937 random( 1 );
+				std::vector< Flowfield::TileVector > positions( LOOKUP_COUNT );
+
+				for( Flowfield::TileVector& position : positions )
+				{
+					position = Flowfield::TileVector( (Flowfield::TileOffset) ( random() % map->getWidth() ), (Flowfield::TileOffset) ( random() % map->getHeight() ) );
+				}
+
+				flowfield->compress();
+				Stopwatch stopwatch;
+
+				for( const Flowfield::TileVector& position : positions )
+				{
+					checksum += flowfield->getCompressedFlow( position ).getBestAdjacency();
+				}
+
+				double lookupTime = ( stopwatch.getElapsedNanoseconds() / LOOKUP_COUNT );
+
+				std::cout << std::right << std::fixed << std::setprecision( 3 )
+						  << std::setw( 12 ) << ( (double) compressedSize / tileCount )
+						  << std::setw( 12 ) << ( getPercentile( compressSamples, 50.0 ) / 1.0e6 )
+						  << std::setw( 12 ) << ( getPercentile( decompressSamples, 50.0 ) / 1.0e6 )
+						  << std::setprecision( 1 ) << std::setw( 12 ) << lookupTime
+						  << std::defaultfloat << std::endl;
+			}
+			else
+			{
+				std::cout << std::right << std::setw( 12 ) << "(kept)" << std::endl;
+			}
+
+			flowfield->destroy();
+		}
+	}
+}
+
+
+int main()
+{
+	if( assertionsAreEnabled() )
+	{
+		std::cout << "WARNING: assertions are enabled; configure with -Db_ndebug=true for meaningful numbers." << std::endl;
+	}
+
+	std::cout << "The planes take " << ( sizeof( FlowData ) + sizeof( unsigned int ) ) << " bytes per tile. Times are in milliseconds, lookups in nanoseconds." << std::endl;
+	std::cout << std::left << std::setw( 18 ) << "map"
+			  << std::setw( 9 ) << "steps"
+			  << std::right << std::setw( 12 ) << "bytes/tile"
+			  << std::setw( 12 ) << "compress"
+			  << std::setw( 12 ) << "expand"
+			  << std::setw( 12 ) << "lookup" << std::endl;
+
+	// The World owns the Map.
+	World* world = new World();
+	Map* map = world->getMap();
+	size_t checksum = 0;
+
+	const size_t sizes[] = { 256, 1024 };
+
+	for( size_t size : sizes )
+	{
+		// Benchmark synthetic maps of increasing size.
+		std::stringstream formatter;
+		formatter << size;
+
+		generateOpenMap( map, size, size );
+		runCases( map, "open-" + formatter.str(), checksum );
+
+		generateMazeMap( map, size, size );
+		runCases( map, "maze-" + formatter.str(), checksum );
+
+		generateRoomsMap( map, size, size );
+		runCases( map, "rooms-" + formatter.str(), checksum );
+
+		generateRoadsMap( map, size, size );
+		runCases( map, "roads-" + formatter.str(), checksum );
+	}
+
+	delete world;
+	return 0;
+}
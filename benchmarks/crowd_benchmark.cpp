@@ -0,0 +1,183 @@
+#include "benchmark.h"
+
+using namespace atc;
+using namespace atc::benchmark;
+
+
+namespace
+{
+	const int MIN_TICKS = 3;
+	const int MAX_TICKS = 200;
+	const double MIN_TOTAL_SECONDS = 2.0;
+	const float UNIT_SPACING = 1.5f;
+	const size_t UNITS_PER_FORMATION = 500;
+	const size_t MAX_FORMATIONS = 16; // Each Formation marches to its own goal, and so has its own flowfield.
+
+
+	/**
+	 * Returns the smallest power of two that is at least the given value.
+	 */
+	size_t getNextPowerOfTwo( size_t value )
+	{
+		size_t result = 1;
+
+		while( result < value )
+		{
+			result <<= 1;
+		}
+
+		return result;
+	}
+
+
+	/**
+	 * Spawns a block of units on an open map, splits them into Formations, and
+	 * times World::update() phase by phase.
+	 */
+	void runCase( size_t unitCount, bool isTrackingDensity )
+	{
+		// The World owns the Map.
+		World* world = new World();
+		Map* map = world->getMap();
+		map->setCrowdDensityEnabled( isTrackingDensity );
+
+		// Size the map so the block of units and its destination both fit.
+		size_t columns = (size_t) ceilf( sqrtf( (float) unitCount ) );
+		size_t rows = ( ( unitCount + columns - 1 ) / columns );
+		float blockWidth = ( columns * UNIT_SPACING );
+		size_t mapSize = std::min< size_t >( getNextPowerOfTwo( (size_t) ( blockWidth * 2.5f ) ), (size_t) Map::MAX_WIDTH );
+		mapSize = std::max< size_t >( mapSize, 64 );
+
+		generateOpenMap( map, mapSize, mapSize );
+
+		// Spawn the units as one block on the left side of the map.
+		float blockBottom = ( ( mapSize - ( rows * UNIT_SPACING ) ) * 0.5f );
+		std::vector< Unit* > units;
+
+		for( size_t i = 0; i < unitCount; ++i )
+		{
+			Point location( 4.0f + ( ( i % columns ) * UNIT_SPACING ), blockBottom + ( ( i / columns ) * UNIT_SPACING ) );
+			units.push_back( world->spawnUnit( location ) );
+		}
+
+		// Split the block into horizontal bands, one Formation per band, and march them across the map.
+		size_t formationCount = std::min< size_t >( std::max< size_t >( unitCount / UNITS_PER_FORMATION, 1 ), MAX_FORMATIONS );
+		size_t unitsPerFormation = ( ( unitCount + formationCount - 1 ) / formationCount );
+		Vector march( std::max( mapSize - 8.0f - blockWidth, 0.0f ), 0.0f );
+
+		for( size_t first = 0; first < unitCount; first += unitsPerFormation )
+		{
+			UnitSelection band;
+
+			for( size_t i = first; i < std::min( first + unitsPerFormation, unitCount ); ++i )
+			{
+				band.addUnit( units[ i ] );
+			}
+
+			Point origin = band.calculateCenterOfMass();
+			Formation* formation = world->createFormation( origin, origin + march, new BoxFormationBehavior( 1.0f ) );
+
+			for( size_t i = first; i < std::min( first + unitsPerFormation, unitCount ); ++i )
+			{
+				formation->addUnit( units[ i ] );
+			}
+		}
+
+		// Run one tick to lay out the formations (which requests their flowfields), then wait for the
+		// flowfields to be built in the background before measuring.
+		world->update( TARGET_FRAME_TIME );
+		map->waitForFlowfields();
+
+		std::vector< double > totalTimes;
+		std::vector< double > phaseTimes[ 7 ];
+		double totalSeconds = 0.0;
+
+		while( (int) totalTimes.size() < MIN_TICKS ||
+			   ( (int) totalTimes.size() < MAX_TICKS && totalSeconds < MIN_TOTAL_SECONDS ) )
+		{
+			world->update( TARGET_FRAME_TIME );
+
+			// Record the time spent in each phase of the tick.
+			const World::UpdateProfile& profile = world->getLastUpdateProfile();
+			totalTimes.push_back( profile.getTotalTime() );
+			phaseTimes[ 0 ].push_back( profile.mapTime );
+			phaseTimes[ 1 ].push_back( profile.formationTime );
+			phaseTimes[ 2 ].push_back( profile.actorTime );
+			phaseTimes[ 3 ].push_back( profile.collisionTime );
+			phaseTimes[ 4 ].push_back( profile.wallCollisionTime );
+			phaseTimes[ 5 ].push_back( profile.crowdTime );
+			phaseTimes[ 6 ].push_back( profile.cleanupTime );
+
+			totalSeconds += profile.getTotalTime();
+		}
+
+		std::cout << std::setw( 8 ) << unitCount
+				  << std::setw( 8 ) << formationCount
+				  << std::setw( 6 ) << totalTimes.size()
+				  << std::fixed << std::setprecision( 3 )
+				  << std::setw( 11 ) << ( getPercentile( totalTimes, 50.0 ) * 1000.0 )
+				  << std::setw( 11 ) << ( getPercentile( totalTimes, 99.0 ) * 1000.0 );
+
+		for( size_t i = 0; i < 7; ++i )
+		{
+			std::cout << std::setw( 11 ) << ( getPercentile( phaseTimes[ i ], 50.0 ) * 1000.0 );
+		}
+
+		std::cout << std::defaultfloat << std::endl;
+
+		delete world;
+	}
+}
+
+
+int main( int argc, char** argv )
+{
+	if( assertionsAreEnabled() )
+	{
+		std::cout << "WARNING: assertions are enabled; configure with -Db_ndebug=true for meaningful numbers." << std::endl;
+	}
+
+	// Use the unit counts from the command line, if any were given. With --density, the
+	// crowds are also splatted into the Map's CrowdDensity each tick.
+	std::vector< size_t > unitCounts;
+	bool isTrackingDensity = false;
+
+	for( int i = 1; i < argc; ++i )
+	{
+		if( strcmp( argv[ i ], "--density" ) == 0 )
+		{
+			isTrackingDensity = true;
+		}
+		else
+		{
+			unitCounts.push_back( (size_t) atol( argv[ i ] ) );
+		}
+	}
+
+	if( unitCounts.empty() )
+	{
+		const size_t defaultUnitCounts[] = { 1000, 2000, 5000, 10000, 20000, 50000, 100000 };
+		unitCounts.assign( std::begin( defaultUnitCounts ), std::end( defaultUnitCounts ) );
+	}
+
+	std::cout << "All times are in milliseconds; phase columns are medians." << std::endl;
+	std::cout << std::setw( 8 ) << "units"
+			  << std::setw( 8 ) << "forms"
+			  << std::setw( 6 ) << "ticks"
+			  << std::setw( 11 ) << "p50 tick"
+			  << std::setw( 11 ) << "p99 tick"
+			  << std::setw( 11 ) << "map"
+			  << std::setw( 11 ) << "formations"
+			  << std::setw( 11 ) << "actors"
+			  << std::setw( 11 ) << "collision"
+			  << std::setw( 11 ) << "walls"
+			  << std::setw( 11 ) << "crowd"
+			  << std::setw( 11 ) << "cleanup" << std::endl;
+
+	for( size_t unitCount : unitCounts )
+	{
+		runCase( unitCount, isTrackingDensity );
+	}
+
+	return 0;
+}
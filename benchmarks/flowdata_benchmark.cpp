@@ -0,0 +1,257 @@
+#include "benchmark.h"
+
+using namespace atc;
+using namespace atc::benchmark;
+
+
+namespace
+{
+	const int MIN_ITERATIONS = 3;
+	const int MAX_ITERATIONS = 50;
+	const double MIN_TOTAL_NANOSECONDS = 5.0e8;
+	const size_t LOOKUP_UNIT_COUNT = 100000;
+	const size_t LOOKUP_STEPS = 8; // About as far as a Unit looks ahead for a shortcut.
+
+
+	/**
+	 * The previous layout of a flowfield tile: every adjacency in order of distance,
+	 * plus the distance itself.
+	 */
+	struct WideFlowData
+	{
+		WideFlowData() :
+			flags( 0 ), adjacencyCount( 0 ), distanceToGoal( 0 )
+		{ }
+
+		unsigned char flags;
+		unsigned char adjacencyCount;
+		unsigned char adjacencies[ CARDINAL_DIRECTION_COUNT ];
+		unsigned int distanceToGoal;
+	};
+
+	const unsigned char WIDE_FLAG_IS_GOAL = 1;
+	const unsigned char WIDE_FLAG_IS_CLOSED = 2;
+
+	typedef Grid< WideFlowData, short, 10 > WideFlowfield;
+
+
+	/**
+	 * Integrates the wide flowfield outward from the goal with a FIFO queue, the same
+	 * way Flowfield::recalculate() does.
+	 */
+	void integrateWideFlowfield( const Map* map, WideFlowfield& flowfield, const Map::TileVector& goal, std::vector< WideFlowfield::TileVector >& queue )
+	{
+		flowfield.clear();
+		queue.resize( flowfield.getWidth() * flowfield.getHeight() );
+		size_t head = 0;
+		size_t tail = 0;
+
+		WideFlowfield::Tile goalTile = flowfield.getTile( goal.x, goal.y );
+		goalTile->flags = ( WIDE_FLAG_IS_GOAL | WIDE_FLAG_IS_CLOSED );
+		queue[ tail++ ] = goalTile.getPosition();
+
+		while( head < tail )
+		{
+			WideFlowfield::Tile tile = flowfield.getTile( queue[ head++ ] );
+			CardinalDirection direction = CARDINAL_DIRECTION_EAST;
+
+			for( size_t i = 0; i < CARDINAL_DIRECTION_COUNT; ++i )
+			{
+				WideFlowfield::Tile adjacentTile = tile.getAdjacentTile( direction );
+
+				if( adjacentTile.isValid() && map->getTile( adjacentTile.getX(), adjacentTile.getY() )->isPassable() )
+				{
+					// Record every adjacency, closest first.
+					adjacentTile->adjacencies[ adjacentTile->adjacencyCount++ ] = (unsigned char) getOppositeDirection( direction );
+
+					if( ( adjacentTile->flags & WIDE_FLAG_IS_CLOSED ) == 0 )
+					{
+						adjacentTile->flags |= WIDE_FLAG_IS_CLOSED;
+						adjacentTile->distanceToGoal = ( tile->distanceToGoal + 1 );
+						queue[ tail++ ] = adjacentTile.getPosition();
+					}
+				}
+
+				direction = getCounterClockwiseDirection( direction );
+			}
+		}
+	}
+
+
+	/**
+	 * Times the given function, and returns the median nanoseconds per call.
+	 */
+	template< typename function_t >
+	double timeMedian( function_t function )
+	{
+		std::vector< double > samples;
+		double totalNanoseconds = 0.0;
+
+		while( (int) samples.size() < MIN_ITERATIONS ||
+			   ( (int) samples.size() < MAX_ITERATIONS && totalNanoseconds < MIN_TOTAL_NANOSECONDS ) )
+		{
+			Stopwatch stopwatch;
+			function();
+			double nanoseconds = stopwatch.getElapsedNanoseconds();
+
+			samples.push_back( nanoseconds );
+			totalNanoseconds += nanoseconds;
+		}
+
+		return getPercentile( samples, 50.0 );
+	}
+
+
+	/**
+	 * Follows the best adjacency a few steps from each start tile, like Units choosing
+	 * where to head next, and returns the number of steps taken.
+	 */
+	template< typename tile_t, typename getBestAdjacency_t >
+	size_t followFlowfield( const std::vector< tile_t >& startTiles, getBestAdjacency_t getBestAdjacency )
+	{
+		size_t result = 0;
+
+		for( const tile_t& startTile : startTiles )
+		{
+			tile_t tile = startTile;
+
+			for( size_t step = 0; step < LOOKUP_STEPS; ++step )
+			{
+				CardinalDirection direction = getBestAdjacency( tile );
+
+				if( direction == CARDINAL_DIRECTION_NONE )
+				{
+					break;
+				}
+
+				tile = tile.getAdjacentTile( direction );
+				++result;
+			}
+		}
+
+		return result;
+	}
+
+
+	/**
+	 * Benchmarks integrating and reading the flowfield toward the central tile of the Map
+	 * with both layouts, and prints one result row.
+	 */
+	void runCase( Map* map, const std::string& name )
+	{
+		Map::TileVector goal = findCentralPassableTile( map );
+		const Map* constMap = map;
+
+		// Set up the current (packed) layout.
+		Flowfield* flowfield = map->createFlowfield();
+		flowfield->setGoalTile( flowfield->getTile( goal.x, goal.y ) );
+		flowfield->setIntegrationMethod( Flowfield::INTEGRATION_METHOD_QUEUE );
+
+		// Set up the wide layout.
+		WideFlowfield wideFlowfield( (unsigned int) map->getWidth(), (unsigned int) map->getHeight() );
+		std::vector< WideFlowfield::TileVector > queue;
+
+		double packedIntegrationNanoseconds = timeMedian( [ flowfield ] { flowfield->recalculate(); } );
+		double wideIntegrationNanoseconds = timeMedian( [ & ] { integrateWideFlowfield( constMap, wideFlowfield, goal, queue ); } );
+
+		// Scatter units over the passable tiles.
+		std::mt19937 random( 1 );
+		std::vector< Flowfield::ConstTile > packedStartTiles;
+		std::vector< WideFlowfield::ConstTile > wideStartTiles;
+		const Flowfield* constFlowfield = flowfield;
+		const WideFlowfield& constWideFlowfield = wideFlowfield;
+
+		while( packedStartTiles.size() < LOOKUP_UNIT_COUNT )
+		{
+			Map::TileOffset x = (Map::TileOffset) ( random() % map->getWidth() );
+			Map::TileOffset y = (Map::TileOffset) ( random() % map->getHeight() );
+
+			if( constFlowfield->getTile( x, y )->isClosed() )
+			{
+				packedStartTiles.push_back( constFlowfield->getTile( x, y ) );
+				wideStartTiles.push_back( constWideFlowfield.getTile( x, y ) );
+			}
+		}
+
+		size_t packedSteps = 0;
+		size_t wideSteps = 0;
+
+		double packedLookupNanoseconds = timeMedian( [ & ]
+		{
+			packedSteps = followFlowfield( packedStartTiles, []( const Flowfield::ConstTile& tile ) { return tile->getBestAdjacency(); } );
+		} );
+
+		double wideLookupNanoseconds = timeMedian( [ & ]
+		{
+			wideSteps = followFlowfield( wideStartTiles, []( const WideFlowfield::ConstTile& tile )
+			{
+				return ( tile->adjacencyCount > 0 ? (CardinalDirection) tile->adjacencies[ 0 ] : CARDINAL_DIRECTION_NONE );
+			} );
+		} );
+
+		// Both layouts must agree on every route.
+		requires( packedSteps == wideSteps );
+
+		size_t packedBytesPerTile = ( sizeof( FlowData ) + sizeof( unsigned int ) );
+		size_t wideBytesPerTile = sizeof( WideFlowData );
+
+		std::cout << std::left << std::setw( 18 ) << name
+				  << std::right << std::setw( 6 ) << map->getWidth() << "x" << std::left << std::setw( 6 ) << map->getHeight()
+				  << std::right << std::setw( 8 ) << wideBytesPerTile
+				  << std::setw( 10 ) << packedBytesPerTile
+				  << std::fixed << std::setprecision( 3 )
+				  << std::setw( 11 ) << ( wideIntegrationNanoseconds / 1.0e6 )
+				  << std::setw( 11 ) << ( packedIntegrationNanoseconds / 1.0e6 )
+				  << std::setprecision( 2 )
+				  << std::setw( 11 ) << ( wideLookupNanoseconds / std::max< size_t >( wideSteps, 1 ) )
+				  << std::setw( 11 ) << ( packedLookupNanoseconds / std::max< size_t >( packedSteps, 1 ) )
+				  << std::defaultfloat << std::endl;
+
+		flowfield->destroy();
+	}
+}
+
+
+int main()
+{
+	if( assertionsAreEnabled() )
+	{
+		std::cout << "WARNING: assertions are enabled; configure with -Db_ndebug=true for meaningful numbers." << std::endl;
+	}
+
+	std::cout << "Compares the wide flowfield tile layout with the packed one. Lookups follow "
+			  << LOOKUP_STEPS << " steps from " << LOOKUP_UNIT_COUNT << " random tiles." << std::endl;
+	std::cout << std::left << std::setw( 18 ) << "map"
+			  << std::right << std::setw( 13 ) << "size"
+			  << std::setw( 8 ) << "B/wide"
+			  << std::setw( 10 ) << "B/packed"
+			  << std::setw( 11 ) << "wide ms"
+			  << std::setw( 11 ) << "packed ms"
+			  << std::setw( 11 ) << "wide ns/st"
+			  << std::setw( 11 ) << "pack ns/st" << std::endl;
+
+	// The World owns the Map.
+	World* world = new World();
+	Map* map = world->getMap();
+
+	const size_t sizes[] = { 256, 512, 1024 };
+
+	for( size_t size : sizes )
+	{
+		// Benchmark synthetic maps of increasing size.
+		std::stringstream formatter;
+		formatter << size;
+
+		generateOpenMap( map, size, size );
+		runCase( map, "open-" + formatter.str() );
+
+		generateMazeMap( map, size, size );
+		runCase( map, "maze-" + formatter.str() );
+
+		generateRoomsMap( map, size, size );
+		runCase( map, "rooms-" + formatter.str() );
+	}
+
+	delete world;
+	return 0;
+}
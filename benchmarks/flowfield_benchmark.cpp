@@ -0,0 +1,274 @@
+#include "benchmark.h"
+
+using namespace atc;
+using namespace atc::benchmark;
+
+
+namespace
+{
+	const int MIN_ITERATIONS = 3;
+	const int MAX_ITERATIONS = 50;
+	const double MIN_TOTAL_NANOSECONDS = 5.0e8;
+
+
+	const char* getIntegrationMethodName( Flowfield::IntegrationMethod method )
+	{
+		const char* result = "";
+
+		switch( method )
+		{
+		case Flowfield::INTEGRATION_METHOD_AUTOMATIC:
+			result = "auto";
+			break;
+
+		case Flowfield::INTEGRATION_METHOD_QUEUE:
+			result = "queue";
+			break;
+
+		case Flowfield::INTEGRATION_METHOD_HEAP:
+			result = "heap";
+			break;
+
+		case Flowfield::INTEGRATION_METHOD_PARALLEL:
+			result = "par";
+			break;
+
+		case Flowfield::INTEGRATION_METHOD_BUCKETS:
+			result = "bucket";
+			break;
+		}
+
+		return result;
+	}
+
+
+	/**
+	 * Times Flowfield::recalculate() toward the central tile of the Map and prints one result row.
+	 * Hierarchical flowfields also load the sectors along the route from the bottom-left corner,
+	 * as a Formation starting there would. Octile flowfields always integrate with buckets.
+	 */
+	void runCase( Map* map, const std::string& name, Flowfield::IntegrationMethod method, bool isHierarchical = false, bool isOctile = false )
+	{
+		// Build the flowfield after the map is set up, so it has the same size.
+		Flowfield* flowfield = map->createFlowfield();
+		Map::TileVector goal = findCentralPassableTile( map );
+		flowfield->setGoalTile( flowfield->getTile( goal.x, goal.y ) );
+		flowfield->setIntegrationMethod( method );
+		flowfield->setHierarchical( isHierarchical );
+		flowfield->setOctile( isOctile );
+
+		std::vector< double > samples;
+		double totalNanoseconds = 0.0;
+
+		while( (int) samples.size() < MIN_ITERATIONS ||
+			   ( (int) samples.size() < MAX_ITERATIONS && totalNanoseconds < MIN_TOTAL_NANOSECONDS ) )
+		{
+			// Time a full recalculation of the field.
+			Stopwatch stopwatch;
+			flowfield->recalculate();
+
+			if( isHierarchical )
+			{
+				flowfield->loadSectorsAlongRoute( Flowfield::TileVector( 1, 1 ) );
+			}
+
+			double nanoseconds = stopwatch.getElapsedNanoseconds();
+
+			samples.push_back( nanoseconds );
+			totalNanoseconds += nanoseconds;
+		}
+
+		const Flowfield::Statistics& statistics = flowfield->getStatistics();
+		double medianNanoseconds = getPercentile( samples, 50.0 );
+		double nanosecondsPerTile = ( medianNanoseconds / std::max< size_t >( statistics.tilesExpanded, 1 ) );
+
+		std::cout << std::left << std::setw( 18 ) << name
+				  << std::setw( 7 ) << ( isHierarchical ? "sector" : ( isOctile ? "octile" : getIntegrationMethodName( method ) ) )
+				  << std::right << std::setw( 6 ) << map->getWidth() << "x" << std::left << std::setw( 6 ) << map->getHeight()
+				  << std::right << std::setw( 10 ) << statistics.tilesExpanded
+				  << std::setw( 12 ) << statistics.queueOperations
+				  << std::setw( 8 ) << samples.size()
+				  << std::fixed << std::setprecision( 3 )
+				  << std::setw( 12 ) << ( medianNanoseconds / 1.0e6 )
+				  << std::setw( 12 ) << nanosecondsPerTile
+				  << std::setprecision( 1 )
+				  << std::setw( 12 ) << ( getPeakResidentSetSize() / ( 1024.0 * 1024.0 ) )
+				  << std::defaultfloat << std::endl;
+
+		flowfield->destroy();
+	}
+
+
+	/**
+	 * Builds flowfields toward the central tile of the Map with parallel integration on several
+	 * thread counts, and returns the number of tiles where any of them differs from the queue.
+	 * Parallel integration promises exactly the same flowfield, ties included.
+	 */
+	size_t countParallelMismatches( Map* map )
+	{
+		ThreadPool* threadPool = map->getThreadPool();
+		size_t hardwareThreadCount = threadPool->getThreadCount();
+		const size_t threadCounts[] = { 2, 4, hardwareThreadCount };
+
+		Map::TileVector goal = findCentralPassableTile( map );
+		Flowfield* queueFlowfield = map->createFlowfield();
+		queueFlowfield->setGoalTile( queueFlowfield->getTile( goal.x, goal.y ) );
+		queueFlowfield->setIntegrationMethod( Flowfield::INTEGRATION_METHOD_QUEUE );
+		queueFlowfield->recalculate();
+
+		Flowfield* parallelFlowfield = map->createFlowfield();
+		parallelFlowfield->setGoalTile( parallelFlowfield->getTile( goal.x, goal.y ) );
+		parallelFlowfield->setIntegrationMethod( Flowfield::INTEGRATION_METHOD_PARALLEL );
+
+		const Flowfield* expected = queueFlowfield;
+		const Flowfield* actual = parallelFlowfield;
+		size_t result = 0;
+
+		for( size_t threadCount : threadCounts )
+		{
+			threadPool->setThreadCount( threadCount );
+			parallelFlowfield->recalculate();
+
+			for( Flowfield::TileOffset y = 0; y < (Flowfield::TileOffset) map->getHeight(); ++y )
+			{
+				for( Flowfield::TileOffset x = 0; x < (Flowfield::TileOffset) map->getWidth(); ++x )
+				{
+					Flowfield::ConstTile expectedTile = expected->getTile( x, y );
+					Flowfield::ConstTile tile = actual->getTile( x, y );
+
+					if( tile->isClosed() != expectedTile->isClosed() ||
+						tile->isGoal() != expectedTile->isGoal() ||
+						tile->hasLineOfSight() != expectedTile->hasLineOfSight() ||
+						tile->getBestAdjacency() != expectedTile->getBestAdjacency() ||
+						( tile->isClosed() && actual->getDistanceToGoal( tile ) != expected->getDistanceToGoal( expectedTile ) ) )
+					{
+						++result;
+					}
+				}
+			}
+		}
+
+		threadPool->setThreadCount( hardwareThreadCount );
+		queueFlowfield->destroy();
+		parallelFlowfield->destroy();
+		return result;
+	}
+
+
+	/**
+	 * Benchmarks the Map with each integration method that suits it (in parallel and hierarchically, if the Map
+	 * is large enough). Maps where some tiles cost more than others can't use the queue, so they use buckets instead.
+	 * Every Map is also run as an octile flowfield. Returns the number of tiles where parallel integration
+	 * differed from the queue.
+	 */
+	size_t runCases( Map* map, const std::string& name )
+	{
+		size_t mismatchCount = 0;
+
+		runCase( map, name, Flowfield::INTEGRATION_METHOD_HEAP );
+
+		if( map->hasWeightedTiles() )
+		{
+			runCase( map, name, Flowfield::INTEGRATION_METHOD_BUCKETS );
+		}
+		else
+		{
+			runCase( map, name, Flowfield::INTEGRATION_METHOD_QUEUE );
+
+			if( ( map->getWidth() * map->getHeight() ) >= Flowfield::PARALLEL_INTEGRATION_MIN_TILES )
+			{
+				mismatchCount = countParallelMismatches( map );
+				runCase( map, name, Flowfield::INTEGRATION_METHOD_PARALLEL );
+
+				if( mismatchCount > 0 )
+				{
+					std::cout << name << ": parallel integration differs from the queue on " << mismatchCount << " tile(s)." << std::endl;
+				}
+			}
+		}
+
+		runCase( map, name, Flowfield::INTEGRATION_METHOD_AUTOMATIC, false, true );
+
+		if( ( map->getWidth() * map->getHeight() ) >= Map::HIERARCHICAL_FLOWFIELD_MIN_TILES )
+		{
+			runCase( map, name, Flowfield::INTEGRATION_METHOD_AUTOMATIC, true );
+		}
+
+		return mismatchCount;
+	}
+}
+
+
+int main()
+{
+	if( assertionsAreEnabled() )
+	{
+		std::cout << "WARNING: assertions are enabled; configure with -Db_ndebug=true for meaningful numbers." << std::endl;
+	}
+
+	// The World owns the Map.
+	World* world = new World();
+	Map* map = world->getMap();
+
+	std::cout << "Parallel (par) integration uses " << map->getThreadPool()->getThreadCount() << " thread(s)." << std::endl;
+
+	if( std::thread::hardware_concurrency() <= 1 )
+	{
+		std::cout << "NOTE: only one hardware thread; par can't beat the queue here, so automatic integration uses the queue." << std::endl;
+	}
+
+	std::cout << std::left << std::setw( 18 ) << "map"
+			  << std::setw( 7 ) << "method"
+			  << std::right << std::setw( 13 ) << "size"
+			  << std::setw( 10 ) << "expanded"
+			  << std::setw( 12 ) << "queue ops"
+			  << std::setw( 8 ) << "runs"
+			  << std::setw( 12 ) << "median ms"
+			  << std::setw( 12 ) << "ns/tile"
+			  << std::setw( 12 ) << "peak MB" << std::endl;
+
+	// Parallel integration is checked against the queue on every map large enough to use it.
+	size_t mismatchCount = 0;
+
+	for( int i = 1; i <= 6; ++i )
+	{
+		// Benchmark each of the shipped maps.
+		std::stringstream formatter;
+		formatter << "0" << i;
+		world->loadMap( formatter.str() );
+		world->destroy();
+
+		mismatchCount += runCases( map, "data/maps/" + formatter.str() );
+	}
+
+	const size_t sizes[] = { 256, 512, 1024 };
+
+	for( size_t size : sizes )
+	{
+		// Benchmark synthetic maps of increasing size.
+		std::stringstream formatter;
+		formatter << size;
+
+		generateOpenMap( map, size, size );
+		mismatchCount += runCases( map, "open-" + formatter.str() );
+
+		generateMazeMap( map, size, size );
+		mismatchCount += runCases( map, "maze-" + formatter.str() );
+
+		generateRoomsMap( map, size, size );
+		mismatchCount += runCases( map, "rooms-" + formatter.str() );
+
+		generateRoadsMap( map, size, size );
+		mismatchCount += runCases( map, "roads-" + formatter.str() );
+	}
+
+	delete world;
+
+	if( mismatchCount > 0 )
+	{
+		std::cout << "FAILED: parallel integration differs from the queue on " << mismatchCount << " tile(s)." << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
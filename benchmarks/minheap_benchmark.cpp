@@ -0,0 +1,205 @@
+#include "benchmark.h"
+
+using namespace atc;
+using namespace atc::benchmark;
+
+
+namespace
+{
+	const int MIN_ITERATIONS = 3;
+	const int MAX_ITERATIONS = 50;
+	const double MIN_TOTAL_NANOSECONDS = 2.0e8;
+
+	// FixedSizeMinHeap keeps its storage inline, so it has to be sized for the largest case up front.
+	const size_t MAX_ELEMENTS = 16384;
+
+	typedef FixedSizeMinHeap< MAX_ELEMENTS + 1, float, int > FixedHeap;
+	typedef IndexedMinHeap< float > IndexedHeap;
+
+
+	/**
+	 * A sequence of heap operations, generated once so both heaps see the same work.
+	 */
+	struct Workload
+	{
+		std::vector< float > insertKeys;
+		std::vector< int > updateElements;
+		std::vector< float > updateKeyDecreases;
+	};
+
+
+	/**
+	 * Inserts the given number of random keys, then lowers the keys of random
+	 * elements (like A* finding a shorter route to an open tile).
+	 */
+	Workload generateWorkload( size_t elementCount, size_t updateCount, unsigned int seed = 1 )
+	{
+		std::mt19937 random( seed );
+		std::uniform_real_distribution< float > keys( 0.0f, 1000.0f );
+		std::uniform_real_distribution< float > decreases( 0.0f, 10.0f );
+		std::uniform_int_distribution< int > elements( 0, (int) elementCount - 1 );
+
+		Workload result;
+
+		for( size_t i = 0; i < elementCount; ++i )
+		{
+			result.insertKeys.push_back( keys( random ) );
+		}
+
+		for( size_t i = 0; i < updateCount; ++i )
+		{
+			result.updateElements.push_back( elements( random ) );
+			result.updateKeyDecreases.push_back( decreases( random ) );
+		}
+
+		return result;
+	}
+
+
+	/**
+	 * Runs the workload against the FixedSizeMinHeap, and returns the sum of the popped elements.
+	 */
+	size_t runFixedHeap( FixedHeap& heap, const Workload& workload, std::vector< float >& keys )
+	{
+		keys = workload.insertKeys;
+
+		for( size_t i = 0; i < keys.size(); ++i )
+		{
+			int element = (int) i;
+			heap.insert( keys[ i ], element );
+		}
+
+		for( size_t i = 0; i < workload.updateElements.size(); ++i )
+		{
+			// Lower the key of the element, wherever it is in the heap.
+			int element = workload.updateElements[ i ];
+			keys[ element ] -= workload.updateKeyDecreases[ i ];
+			heap.update( keys[ element ], element );
+		}
+
+		size_t checksum = 0;
+
+		while( !heap.isEmpty() )
+		{
+			checksum += (size_t) heap.popMinElement();
+		}
+
+		return checksum;
+	}
+
+
+	/**
+	 * Runs the workload against the IndexedMinHeap, and returns the sum of the popped elements.
+	 */
+	size_t runIndexedHeap( IndexedHeap& heap, const Workload& workload, std::vector< float >& keys )
+	{
+		keys = workload.insertKeys;
+
+		for( size_t i = 0; i < keys.size(); ++i )
+		{
+			heap.insert( keys[ i ], i );
+		}
+
+		for( size_t i = 0; i < workload.updateElements.size(); ++i )
+		{
+			// Lower the key of the element, wherever it is in the heap.
+			int element = workload.updateElements[ i ];
+			keys[ element ] -= workload.updateKeyDecreases[ i ];
+			heap.update( keys[ element ], (size_t) element );
+		}
+
+		size_t checksum = 0;
+
+		while( !heap.isEmpty() )
+		{
+			checksum += heap.popMinElement();
+		}
+
+		return checksum;
+	}
+
+
+	/**
+	 * Times one workload with the given heap runner, and returns the median nanoseconds per run.
+	 */
+	template< typename heap_t, typename runner_t >
+	double timeWorkload( heap_t& heap, const Workload& workload, runner_t runner, size_t& checksum )
+	{
+		std::vector< float > keys;
+		std::vector< double > samples;
+		double totalNanoseconds = 0.0;
+
+		while( (int) samples.size() < MIN_ITERATIONS ||
+			   ( (int) samples.size() < MAX_ITERATIONS && totalNanoseconds < MIN_TOTAL_NANOSECONDS ) )
+		{
+			Stopwatch stopwatch;
+			checksum = runner( heap, workload, keys );
+			double nanoseconds = stopwatch.getElapsedNanoseconds();
+
+			samples.push_back( nanoseconds );
+			totalNanoseconds += nanoseconds;
+		}
+
+		return getPercentile( samples, 50.0 );
+	}
+
+
+	/**
+	 * Benchmarks both heaps on the same workload and prints one result row.
+	 */
+	void runCase( FixedHeap& fixedHeap, IndexedHeap& indexedHeap, size_t elementCount, size_t updateCount )
+	{
+		Workload workload = generateWorkload( elementCount, updateCount );
+		indexedHeap.setHandleCount( elementCount );
+
+		size_t fixedChecksum = 0;
+		size_t indexedChecksum = 0;
+		double fixedNanoseconds = timeWorkload( fixedHeap, workload, runFixedHeap, fixedChecksum );
+		double indexedNanoseconds = timeWorkload( indexedHeap, workload, runIndexedHeap, indexedChecksum );
+
+		// Both heaps must pop every element exactly once.
+		requires( fixedChecksum == indexedChecksum );
+
+		std::cout << std::setw( 10 ) << elementCount
+				  << std::setw( 10 ) << updateCount
+				  << std::fixed << std::setprecision( 3 )
+				  << std::setw( 14 ) << ( fixedNanoseconds / 1.0e6 )
+				  << std::setw( 14 ) << ( indexedNanoseconds / 1.0e6 )
+				  << std::setprecision( 1 )
+				  << std::setw( 10 ) << ( fixedNanoseconds / std::max( indexedNanoseconds, 1.0 ) ) << "x"
+				  << std::defaultfloat << std::endl;
+	}
+}
+
+
+int main()
+{
+	if( assertionsAreEnabled() )
+	{
+		std::cout << "WARNING: assertions are enabled; configure with -Db_ndebug=true for meaningful numbers." << std::endl;
+	}
+
+	std::cout << "Each run inserts every element, updates random keys, then pops every element." << std::endl;
+	std::cout << std::setw( 10 ) << "elements"
+			  << std::setw( 10 ) << "updates"
+			  << std::setw( 14 ) << "fixed ms"
+			  << std::setw( 14 ) << "indexed ms"
+			  << std::setw( 11 ) << "speedup" << std::endl;
+
+	// The heaps are far too large for the stack.
+	FixedHeap* fixedHeap = new FixedHeap();
+	IndexedHeap* indexedHeap = new IndexedHeap();
+
+	const size_t elementCounts[] = { 256, 1024, 4096, 16384 };
+
+	for( size_t elementCount : elementCounts )
+	{
+		// Insert and pop only, then with as many updates as elements.
+		runCase( *fixedHeap, *indexedHeap, elementCount, 0 );
+		runCase( *fixedHeap, *indexedHeap, elementCount, elementCount );
+	}
+
+	delete fixedHeap;
+	delete indexedHeap;
+	return 0;
+}
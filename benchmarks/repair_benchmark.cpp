@@ -0,0 +1,338 @@
+#include "benchmark.h"
+
+using namespace atc;
+using namespace atc::benchmark;
+
+
+namespace
+{
+	const int CHANGE_COUNT = 200;
+	const int CHECKED_CHANGE_COUNT = 50;
+	const int MAX_BUILDING_SIZE = 4;
+
+
+	/**
+	 * Places a rectangular building at a random location on the Map, and returns the tiles
+	 * it made impassable.
+	 */
+	std::vector< Map::TileVector > placeRandomBuilding( Map* map, std::mt19937& random )
+	{
+		std::vector< Map::TileVector > result;
+
+		while( result.empty() )
+		{
+			// Find a spot that covers at least one passable tile.
+			int width = ( 1 + (int) ( random() % MAX_BUILDING_SIZE ) );
+			int height = ( 1 + (int) ( random() % MAX_BUILDING_SIZE ) );
+			int left = (int) ( random() % ( map->getWidth() - width ) );
+			int bottom = (int) ( random() % ( map->getHeight() - height ) );
+
+			for( int y = bottom; y < bottom + height; ++y )
+			{
+				for( int x = left; x < left + width; ++x )
+				{
+					Map::TileVector position( (Map::TileOffset) x, (Map::TileOffset) y );
+
+					if( map->getTile( position )->isPassable() )
+					{
+						result.push_back( position );
+					}
+				}
+			}
+		}
+
+		for( const Map::TileVector& position : result )
+		{
+			map->setTilePassable( position, false );
+		}
+
+		return result;
+	}
+
+
+	/**
+	 * Changes the terrain cost of a random patch of passable tiles, repairs the flowfield
+	 * over them as the Map does when congestion changes, and returns the changed tiles.
+	 */
+	std::vector< Map::TileVector > changeRandomTerrainCosts( Map* map, Flowfield* flowfield, std::mt19937& random )
+	{
+		std::vector< Map::TileVector > result;
+		std::vector< Flowfield::TileVector > changedPositions;
+
+		int width = ( 1 + (int) ( random() % MAX_BUILDING_SIZE ) );
+		int height = ( 1 + (int) ( random() % MAX_BUILDING_SIZE ) );
+		int left = (int) ( random() % ( map->getWidth() - width ) );
+		int bottom = (int) ( random() % ( map->getHeight() - height ) );
+		unsigned int cost = ( MapTile::MIN_COST + (unsigned int) ( random() % ( MapTile::MAX_COST - MapTile::MIN_COST + 1 ) ) );
+
+		for( int y = bottom; y < bottom + height; ++y )
+		{
+			for( int x = left; x < left + width; ++x )
+			{
+				Map::Tile tile = map->getTile( (Map::TileOffset) x, (Map::TileOffset) y );
+
+				if( tile->isPassable() && tile->getTerrainCost() != cost )
+				{
+					tile->setTerrainCost( cost );
+					result.push_back( tile.getPosition() );
+					changedPositions.push_back( Flowfield::TileVector( tile.getX(), tile.getY() ) );
+				}
+			}
+		}
+
+		if( !changedPositions.empty() )
+		{
+			flowfield->repair( changedPositions );
+		}
+
+		return result;
+	}
+
+
+	/**
+	 * Returns the number of tiles where a repaired flowfield disagrees with one recalculated
+	 * from scratch. Ties between equally short routes may be broken either way, so a tile's
+	 * direction only has to lead to a neighbor that is closer by the cost of leaving it.
+	 */
+	size_t countRepairMismatches( Map* map, const Flowfield* repaired, const Map::TileVector& goal )
+	{
+		Flowfield* recalculated = map->createFlowfield();
+		recalculated->setGoalTile( recalculated->getTile( goal.x, goal.y ) );
+		recalculated->recalculate();
+
+		const Flowfield* expected = recalculated;
+		size_t result = 0;
+
+		for( Flowfield::TileOffset y = 0; y < (Flowfield::TileOffset) map->getHeight(); ++y )
+		{
+			for( Flowfield::TileOffset x = 0; x < (Flowfield::TileOffset) map->getWidth(); ++x )
+			{
+				Flowfield::ConstTile tile = repaired->getTile( x, y );
+				Flowfield::ConstTile expectedTile = expected->getTile( x, y );
+
+				if( tile->isClosed() != expectedTile->isClosed() )
+				{
+					++result;
+					continue;
+				}
+
+				if( !tile->isClosed() )
+				{
+					continue;
+				}
+
+				unsigned int distance = repaired->getDistanceToGoal( tile );
+				CardinalDirection direction = tile->getBestAdjacency();
+
+				if( distance != expected->getDistanceToGoal( expectedTile ) )
+				{
+					++result;
+				}
+				else if( !tile->isGoal() )
+				{
+					Flowfield::ConstTile nextTile = tile.getAdjacentTile( direction );
+
+					if( direction == CARDINAL_DIRECTION_NONE || !nextTile.isValid() || !nextTile->isClosed() ||
+						( repaired->getDistanceToGoal( nextTile ) + map->getTile( nextTile.getX(), nextTile.getY() )->getCost() ) != distance )
+					{
+						++result;
+					}
+				}
+			}
+		}
+
+		recalculated->destroy();
+		return result;
+	}
+
+
+	/**
+	 * Places and destroys buildings on the Map (and changes the cost of its terrain, if it is
+	 * weighted), comparing the repaired flowfield toward the central tile with a recalculated
+	 * one after each change. Prints one result row, and returns the number of mismatched tiles.
+	 */
+	size_t checkCase( Map* map, const std::string& name, bool changesCosts )
+	{
+		Flowfield* flowfield = map->createFlowfield();
+		Map::TileVector goal = findCentralPassableTile( map );
+		flowfield->setGoalTile( flowfield->getTile( goal.x, goal.y ) );
+		flowfield->recalculate();
+
+		std::mt19937 random( 2 );
+		std::vector< Map::TileVector > building;
+		size_t mismatchCount = 0;
+
+		for( int i = 0; i < CHECKED_CHANGE_COUNT; ++i )
+		{
+			if( changesCosts && ( i % 2 ) == 1 )
+			{
+				changeRandomTerrainCosts( map, flowfield, random );
+			}
+			else if( building.empty() )
+			{
+				building = placeRandomBuilding( map, random );
+				map->update( TARGET_FRAME_TIME );
+			}
+			else
+			{
+				for( const Map::TileVector& position : building )
+				{
+					map->setTilePassable( position, true );
+				}
+
+				building.clear();
+				map->update( TARGET_FRAME_TIME );
+			}
+
+			// Unlike runCase(), keep repairing the same flowfield, so any errors add up.
+			mismatchCount += countRepairMismatches( map, flowfield, goal );
+		}
+
+		for( const Map::TileVector& position : building )
+		{
+			// Leave the map as it was generated.
+			map->setTilePassable( position, true );
+		}
+
+		map->update( TARGET_FRAME_TIME );
+		flowfield->destroy();
+
+		std::cout << std::left << std::setw( 18 ) << name
+				  << std::right << std::setw( 6 ) << map->getWidth() << "x" << std::left << std::setw( 6 ) << map->getHeight()
+				  << std::right << std::setw( 12 ) << mismatchCount
+				  << ( mismatchCount > 0 ? "  MISMATCH" : "" ) << std::endl;
+
+		return mismatchCount;
+	}
+
+
+	/**
+	 * Places and destroys buildings on the Map, and compares the time taken to repair a
+	 * flowfield toward the central tile with the time taken to recalculate it completely.
+	 */
+	void runCase( Map* map, const std::string& name )
+	{
+		Flowfield* flowfield = map->createFlowfield();
+		Map::TileVector goal = findCentralPassableTile( map );
+		flowfield->setGoalTile( flowfield->getTile( goal.x, goal.y ) );
+		flowfield->recalculate();
+
+		std::mt19937 random( 1 );
+		std::vector< double > repairSamples;
+		std::vector< double > recalculateSamples;
+
+		std::vector< Map::TileVector > building;
+
+		for( int i = 0; i < CHANGE_COUNT; ++i )
+		{
+			if( building.empty() )
+			{
+				building = placeRandomBuilding( map, random );
+			}
+			else
+			{
+				// Destroy the building that was just placed.
+				for( const Map::TileVector& position : building )
+				{
+					map->setTilePassable( position, true );
+				}
+
+				building.clear();
+			}
+
+			// Time applying the changed tiles, which repairs the flowfield.
+			Stopwatch stopwatch;
+			map->update( TARGET_FRAME_TIME );
+			repairSamples.push_back( stopwatch.getElapsedNanoseconds() );
+
+			// Then time recalculating it from scratch.
+			stopwatch.restart();
+			flowfield->recalculate();
+			recalculateSamples.push_back( stopwatch.getElapsedNanoseconds() );
+		}
+
+		double repairNanoseconds = getPercentile( repairSamples, 50.0 );
+		double recalculateNanoseconds = getPercentile( recalculateSamples, 50.0 );
+
+		std::cout << std::left << std::setw( 18 ) << name
+				  << std::right << std::setw( 6 ) << map->getWidth() << "x" << std::left << std::setw( 6 ) << map->getHeight()
+				  << std::right << std::fixed << std::setprecision( 3 )
+				  << std::setw( 12 ) << ( repairNanoseconds / 1.0e6 )
+				  << std::setw( 12 ) << ( getPercentile( repairSamples, 99.0 ) / 1.0e6 )
+				  << std::setw( 12 ) << ( recalculateNanoseconds / 1.0e6 )
+				  << std::setprecision( 1 )
+				  << std::setw( 10 ) << ( recalculateNanoseconds / std::max( repairNanoseconds, 1.0 ) ) << "x"
+				  << std::defaultfloat << std::endl;
+
+		flowfield->destroy();
+	}
+}
+
+
+int main()
+{
+	if( assertionsAreEnabled() )
+	{
+		std::cout << "WARNING: assertions are enabled; configure with -Db_ndebug=true for meaningful numbers." << std::endl;
+	}
+
+	// The World owns the Map.
+	World* world = new World();
+	Map* map = world->getMap();
+
+	// Repairs must leave the same distances as recalculating, or the timings mean nothing.
+	std::cout << "Each map has " << CHECKED_CHANGE_COUNT << " changes, each checked against a recalculated flowfield." << std::endl;
+	std::cout << std::left << std::setw( 18 ) << "map"
+			  << std::right << std::setw( 13 ) << "size"
+			  << std::setw( 12 ) << "mismatches" << std::endl;
+
+	size_t mismatchCount = 0;
+
+	generateOpenMap( map, 256, 256 );
+	mismatchCount += checkCase( map, "check-open-256", false );
+
+	generateMazeMap( map, 256, 256 );
+	mismatchCount += checkCase( map, "check-maze-256", false );
+
+	generateRoomsMap( map, 256, 256 );
+	mismatchCount += checkCase( map, "check-rooms-256", false );
+
+	generateRoadsMap( map, 256, 256 );
+	mismatchCount += checkCase( map, "check-roads-256", true );
+
+	if( mismatchCount > 0 )
+	{
+		std::cout << "FAILED: repaired flowfields disagree with recalculated ones on " << mismatchCount << " tile(s)." << std::endl;
+		delete world;
+		return 1;
+	}
+
+	std::cout << std::endl << "Each map has " << CHANGE_COUNT << " buildings placed or destroyed, one at a time." << std::endl;
+	std::cout << std::left << std::setw( 18 ) << "map"
+			  << std::right << std::setw( 13 ) << "size"
+			  << std::setw( 12 ) << "repair p50"
+			  << std::setw( 12 ) << "repair p99"
+			  << std::setw( 12 ) << "full ms"
+			  << std::setw( 11 ) << "speedup" << std::endl;
+
+	const size_t sizes[] = { 256, 512, 1024 };
+
+	for( size_t size : sizes )
+	{
+		// Benchmark synthetic maps of increasing size.
+		std::stringstream formatter;
+		formatter << size;
+
+		generateOpenMap( map, size, size );
+		runCase( map, "open-" + formatter.str() );
+
+		generateMazeMap( map, size, size );
+		runCase( map, "maze-" + formatter.str() );
+
+		generateRoomsMap( map, size, size );
+		runCase( map, "rooms-" + formatter.str() );
+	}
+
+	delete world;
+	return 0;
+}
@@ -0,0 +1,123 @@
+#include "benchmark.h"
+
+using namespace atc;
+using namespace atc::benchmark;
+
+
+namespace
+{
+	/**
+	 * A limit on the flowfield building done in each Map::update().
+	 */
+	struct Budget
+	{
+		const char* name;
+		size_t maxTilesPerFrame;
+		double maxSecondsPerFrame;
+	};
+
+
+	const Budget BUDGETS[] =
+	{
+		{ "16k tiles", 16384, 0.0 },
+		{ "64k tiles", 65536, 0.0 },
+		{ "0.5 ms", 0, 0.0005 },
+		{ "2 ms", 0, 0.002 }
+	};
+
+
+	/**
+	 * Prints one result row.
+	 */
+	void printRow( const std::string& name, const char* budgetName, size_t frameCount, const std::vector< double >& samples )
+	{
+		std::cout << std::left << std::setw( 18 ) << name
+				  << std::setw( 11 ) << budgetName
+				  << std::right << std::setw( 8 ) << frameCount
+				  << std::fixed << std::setprecision( 3 )
+				  << std::setw( 12 ) << ( getPercentile( samples, 50.0 ) / 1.0e6 )
+				  << std::setw( 12 ) << ( getPercentile( samples, 100.0 ) / 1.0e6 )
+				  << std::defaultfloat << std::endl;
+	}
+
+
+	/**
+	 * Builds a flowfield toward the central tile of the Map a slice per Map::update() with
+	 * each budget, and compares the time spent in each update with building it all at once.
+	 */
+	void runCases( Map* map, const std::string& name )
+	{
+		Map::TileVector goal = findCentralPassableTile( map );
+		Flowfield* flowfield = map->createFlowfield();
+		flowfield->setGoalTile( flowfield->getTile( goal.x, goal.y ) );
+
+		// Build it all at once, as a single frame would without a budget.
+		std::vector< double > samples;
+		Stopwatch stopwatch;
+		flowfield->recalculate();
+		samples.push_back( stopwatch.getElapsedNanoseconds() );
+		printRow( name, "none", 1, samples );
+
+		for( const Budget& budget : BUDGETS )
+		{
+			map->setFlowfieldBuildBudget( budget.maxTilesPerFrame, budget.maxSecondsPerFrame );
+			flowfield->recalculateAsync();
+			samples.clear();
+
+			while( !flowfield->isReady() )
+			{
+				// Time each update until the flowfield has been built.
+				stopwatch.restart();
+				map->update( TARGET_FRAME_TIME );
+				samples.push_back( stopwatch.getElapsedNanoseconds() );
+			}
+
+			printRow( name, budget.name, samples.size(), samples );
+		}
+
+		// Go back to building flowfields on the worker thread.
+		map->setFlowfieldBuildBudget( 0, 0.0 );
+		flowfield->destroy();
+	}
+}
+
+
+int main()
+{
+	if( assertionsAreEnabled() )
+	{
+		std::cout << "WARNING: assertions are enabled; configure with -Db_ndebug=true for meaningful numbers." << std::endl;
+	}
+
+	std::cout << "Update times are in milliseconds." << std::endl;
+	std::cout << std::left << std::setw( 18 ) << "map"
+			  << std::setw( 11 ) << "budget"
+			  << std::right << std::setw( 8 ) << "frames"
+			  << std::setw( 12 ) << "p50 update"
+			  << std::setw( 12 ) << "max update" << std::endl;
+
+	// The World owns the Map.
+	World* world = new World();
+	Map* map = world->getMap();
+
+	const size_t sizes[] = { 256, 1024 };
+
+	for( size_t size : sizes )
+	{
+		// Benchmark synthetic maps of increasing size.
+		std::stringstream formatter;
+		formatter << size;
+
+		generateOpenMap( map, size, size );
+		runCases( map, "open-" + formatter.str() );
+
+		generateMazeMap( map, size, size );
+		runCases( map, "maze-" + formatter.str() );
+
+		generateRoomsMap( map, size, size );
+		runCases( map, "rooms-" + formatter.str() );
+	}
+
+	delete world;
+	return 0;
+}
@@ -1,7 +1,7 @@
 #ifndef ATC_ANGLE_H
 #define ATC_ANGLE_H
 
-#include "Math.h"
+#include "MathHelper.h"
 
 #include "Vector.h"
 
@@ -62,6 +62,10 @@ namespace atc
 		static const Angle NORTH;
 		static const Angle WEST;
 		static const Angle SOUTH;
+		static const Angle NORTHEAST;
+		static const Angle NORTHWEST;
+		static const Angle SOUTHWEST;
+		static const Angle SOUTHEAST;
 
 		static Angle createFromRadians( float radians );
 		static Angle createFromDegrees( float degrees );
@@ -0,0 +1,45 @@
+#ifndef ATC_BUCKETQUEUE_H
+#define ATC_BUCKETQUEUE_H
+
+namespace atc
+{
+	/**
+	 * Priority queue for small integer keys that only ever grow (as in Dijkstra's
+	 * algorithm with small integer step costs). Elements are kept in a ring of
+	 * buckets, one per key, so inserts and pops take constant time. Every key
+	 * in the queue must be within the maximum key spread of the minimum one.
+	 */
+	template< typename value_t >
+	class BucketQueue
+	{
+	public:
+		typedef value_t Value;
+		typedef unsigned int Key;
+
+		BucketQueue();
+		~BucketQueue();
+
+		void setMaxKeySpread( Key maxKeySpread );
+		Key getMaxKeySpread() const;
+
+		void insert( Key key, const Value& value );
+		Value popMinElement();
+		Value peekMinElement() const;
+		Key peekMinKey() const;
+		void clear();
+
+		size_t getSize() const;
+		bool isEmpty() const;
+
+	protected:
+		std::vector< Value >& getBucket( Key key );
+		const std::vector< Value >& getBucket( Key key ) const;
+
+		std::vector< std::vector< Value > > m_buckets;
+		size_t m_bucketMask; // (There are always a power of two buckets)
+		Key m_minKey; // (No greater than any key in the queue)
+		size_t m_size;
+	};
+}
+
+#endif
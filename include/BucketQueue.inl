@@ -0,0 +1,154 @@
+#ifndef ATC_BUCKETQUEUE_INL
+#define ATC_BUCKETQUEUE_INL
+
+namespace atc
+{
+	template< typename value_t >
+	BucketQueue< value_t >::BucketQueue() :
+		m_buckets( 2 ),
+		m_bucketMask( 1 ),
+		m_minKey( 0 ),
+		m_size( 0 )
+	{ }
+
+
+	template< typename value_t >
+	BucketQueue< value_t >::~BucketQueue() { }
+
+
+	template< typename value_t >
+	void BucketQueue< value_t >::setMaxKeySpread( Key maxKeySpread )
+	{
+		requires( isEmpty() );
+
+		// Keep a bucket for every key from the minimum to the minimum plus the spread, rounding
+		// up to a power of two so keys can be masked onto the ring.
+		size_t bucketCount = 1;
+
+		while( bucketCount <= maxKeySpread )
+		{
+			bucketCount <<= 1;
+		}
+
+		m_buckets.resize( bucketCount );
+		m_bucketMask = ( bucketCount - 1 );
+	}
+
+
+	template< typename value_t >
+	typename BucketQueue< value_t >::Key BucketQueue< value_t >::getMaxKeySpread() const
+	{
+		// (Any spread that fits in the ring is allowed.)
+		return (Key) m_bucketMask;
+	}
+
+
+	template< typename value_t >
+	void BucketQueue< value_t >::insert( Key key, const Value& value )
+	{
+		if( isEmpty() && ( key < m_minKey || ( key - m_minKey ) > getMaxKeySpread() ) )
+		{
+			// Start the ring from this key, unless it's within reach of the last key popped (since
+			// keys between the two may still be inserted).
+			m_minKey = key;
+		}
+
+		// Keys wrap around the ring, so each has to stay within reach of the last key popped.
+		requires( key >= m_minKey && ( key - m_minKey ) <= getMaxKeySpread() );
+
+		getBucket( key ).push_back( value );
+		++m_size;
+	}
+
+
+	template< typename value_t >
+	value_t BucketQueue< value_t >::popMinElement()
+	{
+		requires( !isEmpty() );
+
+		// Move on to the first key that has any elements. This waits until now, since keys
+		// between the last one popped and the next may still be inserted.
+		while( getBucket( m_minKey ).empty() )
+		{
+			++m_minKey;
+		}
+
+		// Take the most recently added element with the minimum key.
+		std::vector< Value >& bucket = getBucket( m_minKey );
+		Value value = bucket.back();
+		bucket.pop_back();
+		--m_size;
+
+		// Return the popped value.
+		return value;
+	}
+
+
+	template< typename value_t >
+	value_t BucketQueue< value_t >::peekMinElement() const
+	{
+		// Return the element that would be popped next.
+		return getBucket( peekMinKey() ).back();
+	}
+
+
+	template< typename value_t >
+	typename BucketQueue< value_t >::Key BucketQueue< value_t >::peekMinKey() const
+	{
+		requires( !isEmpty() );
+
+		// Find the first key that has any elements.
+		Key key = m_minKey;
+
+		while( getBucket( key ).empty() )
+		{
+			++key;
+		}
+
+		return key;
+	}
+
+
+	template< typename value_t >
+	void BucketQueue< value_t >::clear()
+	{
+		for( std::vector< Value >& bucket : m_buckets )
+		{
+			// Remove all elements, but keep the storage for reuse.
+			bucket.clear();
+		}
+
+		m_minKey = 0;
+		m_size = 0;
+	}
+
+
+	template< typename value_t >
+	size_t BucketQueue< value_t >::getSize() const
+	{
+		return m_size;
+	}
+
+
+	template< typename value_t >
+	bool BucketQueue< value_t >::isEmpty() const
+	{
+		return ( m_size == 0 );
+	}
+
+
+	template< typename value_t >
+	std::vector< value_t >& BucketQueue< value_t >::getBucket( Key key )
+	{
+		return m_buckets[ key & m_bucketMask ];
+	}
+
+
+	template< typename value_t >
+	const std::vector< value_t >& BucketQueue< value_t >::getBucket( Key key ) const
+	{
+		return m_buckets[ key & m_bucketMask ];
+	}
+}
+
+#endif
@@ -1,7 +1,7 @@
 #ifndef ATC_COLOR_INL
 #define ATC_COLOR_INL
 
-#include "Math.h"
+#include "MathHelper.h"
 
 namespace atc
 {
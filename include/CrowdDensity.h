@@ -0,0 +1,83 @@
+#ifndef ATC_CROWDDENSITY_H
+#define ATC_CROWDDENSITY_H
+
+namespace atc
+{
+	/**
+	 * Splats the positions and velocities of Units into a coarse grid over a
+	 * Map each tick, in the spirit of continuum crowds. Cells that stay
+	 * crowded with Units that aren't getting anywhere are given a congestion
+	 * cost, which the Map adds to the cost of stepping onto their tiles, so
+	 * flowfields steer later arrivals around the jam.
+	 */
+	class CrowdDensity
+	{
+	public:
+		typedef Map::TileVector TileVector;
+
+		static const int CELL_SIZE = 8; // Tiles along each side of a cell. (Divides SectorGraph::SECTOR_SIZE, so each cell is in one sector.)
+		static const size_t MIN_UNITS_PER_THREAD = 4096;
+		static const unsigned int MAX_CONGESTION_COST = 8;
+		static const float SMOOTHING_TIME; // seconds
+		static const float CONGESTED_DENSITY; // Units per passable tile, once none of them are moving.
+		static const float DENSITY_PER_COST; // Units per passable tile beyond CONGESTED_DENSITY, for each point of cost.
+
+		CrowdDensity( const Map* map );
+		~CrowdDensity();
+
+		void clear();
+		void invalidatePassableTileCounts();
+
+		void clearUnits();
+		void addUnit( const Point& position, const Vector& velocity );
+		void update( double elapsedTime );
+
+		size_t getCellIndex( const TileVector& position ) const;
+		TileVector getCellOrigin( size_t cell ) const;
+		size_t getCellCount() const;
+		size_t getCellsWide() const;
+		size_t getCellsHigh() const;
+		size_t getUnitCount() const;
+		ThreadPool* getThreadPool();
+
+		float getCongestion( size_t cell ) const;
+		unsigned int getCongestionCost( size_t cell ) const;
+
+	protected:
+		/**
+		 * The Units one thread has splatted into one cell.
+		 */
+		struct CellSplat
+		{
+			CellSplat();
+
+			float unitCount;
+			float velocityX;
+			float velocityY;
+		};
+
+		void resize();
+		void countPassableTiles();
+		void splatUnits( size_t threadIndex, size_t threadCount );
+		void gatherCells( size_t threadIndex, size_t threadCount, float smoothing );
+
+		const Map* m_map;
+		size_t m_cellsWide;
+		size_t m_cellsHigh;
+		bool m_arePassableTileCountsValid;
+		std::vector< unsigned int > m_passableTileCounts;
+		std::vector< float > m_congestions; // Units per passable tile, discounted by how fast they move, and smoothed over time.
+		std::vector< unsigned int > m_congestionCosts;
+
+		// The Units to splat, one array per component, so the cell of each can be found in a vectorizable loop.
+		std::vector< float > m_unitXs;
+		std::vector< float > m_unitYs;
+		std::vector< float > m_unitVelocityXs;
+		std::vector< float > m_unitVelocityYs;
+		std::vector< unsigned int > m_unitCells;
+		std::vector< std::vector< CellSplat > > m_splatsByThread;
+		ThreadPool m_threadPool; // (Its own, so splatting never waits on a Flowfield being integrated in parallel)
+	};
+}
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef ATC_CROWDDENSITY_INL
+#define ATC_CROWDDENSITY_INL
+
+namespace atc
+{
+	// ------------------------------ CellSplat ------------------------------
+
+	inline CrowdDensity::CellSplat::CellSplat() :
+		unitCount( 0.0f ),
+		velocityX( 0.0f ),
+		velocityY( 0.0f )
+	{ }
+
+
+	// ------------------------------ CrowdDensity ------------------------------
+
+	inline size_t CrowdDensity::getCellIndex( const TileVector& position ) const
+	{
+		return ( ( position.x / CELL_SIZE ) + ( ( position.y / CELL_SIZE ) * m_cellsWide ) );
+	}
+
+
+	inline CrowdDensity::TileVector CrowdDensity::getCellOrigin( size_t cell ) const
+	{
+		return TileVector( (Map::TileOffset) ( ( cell % m_cellsWide ) * CELL_SIZE ), (Map::TileOffset) ( ( cell / m_cellsWide ) * CELL_SIZE ) );
+	}
+
+
+	inline size_t CrowdDensity::getCellCount() const
+	{
+		return ( m_cellsWide * m_cellsHigh );
+	}
+
+
+	inline size_t CrowdDensity::getCellsWide() const
+	{
+		return m_cellsWide;
+	}
+
+
+	inline size_t CrowdDensity::getCellsHigh() const
+	{
+		return m_cellsHigh;
+	}
+
+
+	inline size_t CrowdDensity::getUnitCount() const
+	{
+		return m_unitXs.size();
+	}
+
+
+	inline ThreadPool* CrowdDensity::getThreadPool()
+	{
+		return &m_threadPool;
+	}
+
+
+	inline float CrowdDensity::getCongestion( size_t cell ) const
+	{
+		return m_congestions[ cell ];
+	}
+
+
+	inline unsigned int CrowdDensity::getCongestionCost( size_t cell ) const
+	{
+		return m_congestionCosts[ cell ];
+	}
+}
+
+#endif
@@ -4,10 +4,15 @@
 namespace atc
 {
 	class Map;
+	class SectorGraph;
 
 	/**
 	 * Represents the collected information about a tile from a
-	 * flowfield pathfinding search.
+	 * flowfield pathfinding search, packed into a single byte: the best
+	 * direction toward the goal, whether the tile is the goal or has
+	 * been reached, and whether the goal is in view from the tile. The
+	 * Flowfield stores each tile's distance to the goal in a separate
+	 * array, since units only ever need the direction.
 	 */
 	class FlowData
 	{
@@ -15,8 +20,10 @@ namespace atc
 		enum Flags
 		{
 			FLAG_NONE = 0,
-			FLAG_IS_GOAL = 1,
-			FLAG_IS_CLOSED = 2
+			FLAG_DIRECTION_MASK = 15, // (Really a CardinalDirection)
+			FLAG_IS_GOAL = 16,
+			FLAG_IS_CLOSED = 32,
+			FLAG_HAS_LINE_OF_SIGHT = 64
 		};
 
 		FlowData();
@@ -26,55 +33,340 @@ namespace atc
 		bool isGoal() const;
 		void setClosed( bool isClosed );
 		bool isClosed() const;
+		void setLineOfSight( bool hasLineOfSight );
+		bool hasLineOfSight() const;
 
-		void clearAdjacencies();
-		size_t getAdjacencyCount() const;
-		void addAdjacency( CardinalDirection direction );
-		CardinalDirection getAdjacency( size_t index ) const;
+		void setBestAdjacency( CardinalDirection direction );
 		CardinalDirection getBestAdjacency() const;
-		bool hasAdjacency( CardinalDirection direction ) const;
 
-		void setDistanceToGoal( unsigned int distance );
-		unsigned int getDistanceToGoal() const;
+		bool operator==( const FlowData& other ) const;
+		bool operator!=( const FlowData& other ) const;
 
 	protected:
 		unsigned char m_flags;
-		unsigned char m_adjacencyCount;
-		unsigned char m_adjacencies[ CARDINAL_DIRECTION_COUNT ]; // (Really a CardinalDirection)
-		unsigned int m_distanceToGoal;
 	};
 
 
 	/**
-	 * Stores the results of a flow field pathfinding search.
+	 * Stores the results of a flow field pathfinding search, as a plane of
+	 * FlowData (one byte per tile) and a plane of distances to the goal.
 	 */
 	class Flowfield : public Grid< FlowData, short, 10 >
 	{
 	public:
+		// Once more than 1 / REPAIR_FALLBACK_DIVISOR of the tiles are invalidated, repair() recalculates instead.
+		static const size_t REPAIR_FALLBACK_DIVISOR = 8;
+
+		// Builds that reach more than 1 / CLEAR_REACHED_DIVISOR of the tiles clear the whole flow plane before the next one.
+		static const size_t CLEAR_REACHED_DIVISOR = 8;
+
+		// Automatic integration goes parallel for fields with at least this many tiles, if there are threads to spare.
+		static const size_t PARALLEL_INTEGRATION_MIN_TILES = ( 256 * 256 );
+
+		// Parallel integration splits a wavefront across threads once it reaches this many tiles, and goes back to a
+		// single thread once it drops below half as many. Smaller wavefronts aren't worth crossing a ThreadBarrier for.
+		static const size_t PARALLEL_MIN_WAVEFRONT_SIZE = 256;
+
+		// The vector field stores each component of a unit vector as a signed byte, scaled by this.
+		static const int FIELD_VECTOR_SCALE = 127;
+
+		// Samples of the vector field that blend to less than this are dropped, since the tiles around them point too
+		// many different ways (e.g. on either side of a thin wall) for the blend to mean anything.
+		static const int MIN_BLENDED_FIELD_VECTOR_LENGTH = ( FIELD_VECTOR_SCALE / 2 );
+
+		// Octile flowfields scale every step by these, so a diagonal step costs close to sqrt( 2 ) straight ones.
+		static const unsigned int OCTILE_STRAIGHT_STEP_COST = 5;
+		static const unsigned int OCTILE_DIAGONAL_STEP_COST = 7;
+
+		// Saved flowfields start with these, so files from elsewhere (or older versions) are never loaded.
+		static const uint32_t FILE_MAGIC = 0x46435441; // "ATCF"
+		static const uint32_t FILE_VERSION = 1;
+
+		/**
+		 * Determines which open list recalculate() uses to expand tiles.
+		 */
+		enum IntegrationMethod
+		{
+			INTEGRATION_METHOD_AUTOMATIC,
+			INTEGRATION_METHOD_QUEUE, // First-in, first-out queue (only when every tile costs the same).
+			INTEGRATION_METHOD_HEAP,    // Min-heap (exact for any tile costs).
+			INTEGRATION_METHOD_PARALLEL, // Wavefronts of equal distance split across the Map's ThreadPool (same results as the queue).
+			INTEGRATION_METHOD_BUCKETS  // Ring of buckets, one per distance (exact for any tile costs, and cheaper than the heap).
+		};
+
+		/**
+		 * Whether the results of the Flowfield can be read.
+		 */
+		enum Status
+		{
+			STATUS_EMPTY,    // Never calculated.
+			STATUS_QUEUED,   // Waiting to be recalculated on the worker thread.
+			STATUS_BUILDING, // Being recalculated.
+			STATUS_PARTIAL,  // Being recalculated a slice at a time on the main thread (tiles reached so far are final).
+			STATUS_READY     // Completely calculated (and safe to read from the simulation).
+		};
+
+		/**
+		 * Counters collected during the most recent call to recalculate().
+		 */
+		struct Statistics
+		{
+			Statistics();
+
+			size_t tilesExpanded;
+			size_t queueOperations;
+		};
+
 		void recalculate();
+		void recalculateAsync();
+		void beginRecalculation();
+		bool continueRecalculation( size_t maxTileCount );
+		void repair( const std::vector< TileVector >& changedPositions );
 		void destroy();
 
+		bool loadFromFile( const std::string& path );
+		bool saveToFile( const std::string& path ) const;
+
+		bool compress();
+		void decompress();
+		void discard();
+		bool isCompressed() const;
+		FlowData getCompressedFlow( const TileVector& position ) const;
+		unsigned int getCompressedDistanceToGoal( const TileVector& position ) const;
+		size_t getCompressedSize() const;
+
+		Status getStatus() const;
+		bool isReady() const;
+		bool isTileFinal( const ConstTile& tile ) const;
+		bool isShared() const;
+		size_t getReferenceCount() const;
+
 		void setGoalTile( const Tile& tile );
 		Tile getGoalTile();
 		ConstTile getGoalTile() const;
+		void setGoalRegion( const std::vector< TileVector >& positions );
+		const std::vector< TileVector >& getGoalRegion() const;
+
+		unsigned int getDistanceToGoal( const ConstTile& tile ) const;
+
+		void setLineOfSightRadius( float radius );
+		float getLineOfSightRadius() const;
+		bool hasLineOfSight( const ConstTile& tile, float radius ) const;
+		bool hasLineOfSight( const ConstTile& start, const ConstTile& end, float radius ) const;
+
+		void setVectorFieldEnabled( bool isEnabled );
+		bool isVectorFieldEnabled() const;
+		bool hasVectorField() const;
+		Vector sampleVectorField( float x, float y ) const;
+
+		void setHierarchical( bool isHierarchical );
+		bool isHierarchical() const;
+		void setOctile( bool isOctile );
+		bool isOctile() const;
+		bool cutsCorner( const TileVector& position, CardinalDirection direction ) const;
+		void loadSector( size_t sector );
+		void loadSectorAt( const TileVector& position );
+		void loadSectorsAlongRoute( const TileVector& start );
+		void reloadSector( size_t sector );
+		bool isSectorLoaded( size_t sector ) const;
+		size_t getLoadedSectorCount() const;
+
+		void setIntegrationMethod( IntegrationMethod method );
+		IntegrationMethod getIntegrationMethod() const;
+		IntegrationMethod chooseIntegrationMethod() const;
+
+		const Statistics& getStatistics() const;
 
 	protected:
+		/**
+		 * A tile reached by one thread's share of a wavefront during parallel integration.
+		 */
+		struct OpenedTile
+		{
+			OpenedTile() { }
+			OpenedTile( const TileVector& position, CardinalDirection bestAdjacency ) :
+				position( position ), bestAdjacency( bestAdjacency )
+			{ }
+
+			TileVector position;
+			CardinalDirection bestAdjacency;
+		};
+
+		/**
+		 * A closed tile waiting in the buckets of an octile integration to be stepped from,
+		 * either to its straight neighbors or to its diagonal ones.
+		 */
+		struct OctileStep
+		{
+			OctileStep() { }
+			OctileStep( const Tile& tile, bool isDiagonal ) :
+				tile( tile ), isDiagonal( isDiagonal )
+			{ }
+
+			Tile tile;
+			bool isDiagonal;
+		};
+
+		/**
+		 * The start of a file written by saveToFile(). It is followed by the goal region, the distance plane,
+		 * and the flow plane, each laid out exactly as in memory, so the planes can be read (or mapped)
+		 * straight into place.
+		 */
+		struct FileHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint64_t mapHash; // The content hash of the Map the Flowfield was built over.
+			uint32_t width;
+			uint32_t height;
+			int32_t goalX;
+			int32_t goalY;
+			uint32_t goalRegionSize;
+			uint32_t flags;
+		};
+
+		enum FileFlags
+		{
+			FILE_FLAG_NONE = 0,
+			FILE_FLAG_OCTILE = 1
+		};
+
+		/**
+		 * The direction down the slope of the distance to the goal at a tile, with each
+		 * component scaled by FIELD_VECTOR_SCALE. (Zero where there is no way to the goal)
+		 */
+		struct FieldVector
+		{
+			FieldVector() { }
+			FieldVector( signed char x, signed char y ) :
+				x( x ), y( y )
+			{ }
+
+			signed char x;
+			signed char y;
+		};
+
+		/**
+		 * Tiles along a row of a compressed Flowfield whose distances to the goal change by the same step
+		 * from each tile to the next, and whose FlowData alternates between two values. (Where a flowfield
+		 * heads diagonally, the best direction of each tile alternates between the two straight ones.)
+		 */
+		struct FlowRun
+		{
+			FlowRun() { }
+			FlowRun( TileOffset x, const FlowData& flow, unsigned int distanceToGoal ) :
+				distanceToGoal( distanceToGoal ), x( x ), distanceStep( 0 )
+			{
+				flows[ 0 ] = flow;
+				flows[ 1 ] = flow;
+			}
+
+			unsigned int distanceToGoal; // (Of the first tile)
+			TileOffset x; // (Of the first tile)
+			FlowData flows[ 2 ]; // (For the tiles an even and an odd number of tiles from the first)
+			signed char distanceStep;
+		};
+
 		Flowfield();
 		~Flowfield();
 
-		void evaluateTile( Tile tile, CardinalDirection direction );
+		bool integrateWithQueue( size_t maxTileCount );
+		bool integrateWithHeap( size_t maxTileCount );
+		bool integrateWithBuckets( size_t maxTileCount );
+		bool integrateOctile( size_t maxTileCount );
+		bool integrateInParallel( size_t maxTileCount );
+		void integrateWavefronts( size_t threadIndex, size_t threadCount, ThreadBarrier& barrier, size_t maxTileCount );
+		bool isFirstToReach( const TileVector& position, unsigned int queueOrder ) const;
+		void integrateSectorGraph();
+		bool evaluateTile( Tile tile, CardinalDirection direction, Tile& adjacentTile );
+		void invalidateTile( Tile tile );
+		bool isInvalidated( const Tile& tile ) const;
+		void updateBestAdjacency( Tile tile );
+		size_t getDirectionCount() const;
+		CardinalDirection getNextDirection( CardinalDirection direction ) const;
+
+		void allocatePlanes();
+		void clearFlows();
+		const FlowRun& findCompressedRun( const TileVector& position ) const;
+
+		void findLinesOfSight();
+		bool isClearAround( const TileVector& position, int clearance ) const;
+
+		void findFieldVectors();
+		void updateFieldVector( const TileVector& position );
+		float getDescent( const TileVector& position, const TileVector& offset ) const;
+
+		void setDistanceToGoal( const Tile& tile, unsigned int distance );
+		unsigned int getTileCost( const TileVector& position ) const;
+		unsigned int getStepCost( const TileVector& position, CardinalDirection direction ) const;
+
+		void setStatus( Status status );
 
-		void reserve();
-		void release();
-		bool isReserved() const;
-		bool isAvailable() const;
+		void addReference();
+		void removeReference();
 
-		bool m_isReserved;
+		bool m_isShared;
+		size_t m_referenceCount;
+		std::atomic< Status > m_status;
 		Map* m_map;
 		Tile m_goalTile;
-		FixedSizeMinHeap< MAX_TILES, unsigned int, Tile > m_tilesToEvaluate;
+		std::vector< TileVector > m_goalRegion; // More goals around the goal tile, searched from along with it.
+		std::vector< Tile > m_goalTiles; // Every goal the search started from.
+		IntegrationMethod m_integrationMethod;
+		IntegrationMethod m_activeIntegrationMethod; // (The one chosen by the recalculation in progress)
+		Statistics m_statistics;
+		std::vector< unsigned int > m_distancesToGoal; // (Only valid for closed tiles)
+
+		// Every tile written since the flow plane was last cleared is a goal, reached from one through closed tiles, or has a
+		// line of sight, so the next build can clear just those. (Unless the Flowfield was hierarchical, loaded, or reached
+		// too many tiles) This makes a reset cost as much as the last build reached, rather than nothing as with an epoch
+		// stamp per tile. But a stamp would be larger than the one-byte tile it guards, and every read of the flow plane
+		// (integration, following, compression) would have to check it. Builds that reach most of the Map pay for a
+		// full clear of the plane instead, which is sized to the Map.
+		bool m_canClearReachedTiles;
+		std::vector< TileVector > m_tilesToClear;
+		std::vector< TileVector > m_tileQueue;
+		size_t m_tileQueueHead;
+		size_t m_tileQueueTail;
+		std::vector< unsigned int > m_queueOrders; // Where each closed tile is in m_tileQueue (parallel integration only).
+		std::vector< std::vector< OpenedTile > > m_openedTilesByThread;
+		MinHeap< unsigned int, Tile > m_tilesToEvaluate;
+		BucketQueue< Tile > m_tileBuckets;
+
+		// Octile flowfields also step diagonally, though never across the corner of an impassable tile.
+		bool m_isOctile;
+		BucketQueue< OctileStep > m_octileBuckets;
+
+		// Tiles from which something of the line of sight radius can move straight to anywhere in the goal tile.
+		float m_lineOfSightRadius; // (Negative if lines of sight aren't found)
+		TileVector m_lineOfSightMin; // Bounds of the tiles with a line of sight, so they can be cleared after a repair.
+		TileVector m_lineOfSightMax;
+
+		// A continuous field of directions toward the goal, sampled between tile centers, so Units can steer without tracing.
+		bool m_isVectorFieldEnabled;
+		std::vector< FieldVector > m_fieldVectors; // (Empty unless enabled, and the Flowfield is ready and not hierarchical)
+
+		// Tiles whose distance is being found again by repair(), each marked with the current repair stamp.
+		std::vector< Tile > m_repairedTiles;
+		std::vector< unsigned int > m_repairStamps;
+		unsigned int m_repairStamp;
+
+		// Unused flowfields are kept as runs along each row, with the planes (and scratch space) freed.
+		bool m_isCompressed;
+		std::vector< FlowRun > m_compressedRuns;
+		std::vector< size_t > m_compressedRowStarts; // Index of the first run of each row. (Followed by the run count)
+
+		// Hierarchical flowfields only integrate the sectors that have been loaded, using the
+		// distance to the goal from each portal (found by searching the Map's SectorGraph).
+		bool m_isHierarchical;
+		const SectorGraph* m_sectorGraph;
+		std::vector< unsigned int > m_portalNodeDistances;
+		std::vector< bool > m_loadedSectors;
+		size_t m_loadedSectorCount;
+		MinHeap< unsigned int, size_t > m_nodesToEvaluate;
 
 		friend class Map;
+		friend class FlowfieldWorker;
 	};
 }
 
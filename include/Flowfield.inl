@@ -6,9 +6,7 @@ namespace atc
 	// ------------------------------ FlowData ------------------------------
 
 	inline FlowData::FlowData() :
-		m_flags( FLAG_NONE ),
-		m_adjacencyCount( 0 ),
-		m_distanceToGoal( 0 )
+		m_flags( FLAG_NONE )
 	{ }
 
 
@@ -53,101 +51,266 @@ namespace atc
 	}
 
 
-	inline void FlowData::clearAdjacencies()
+	inline void FlowData::setLineOfSight( bool hasLineOfSight )
 	{
-		m_adjacencyCount = 0;
+		if( hasLineOfSight )
+		{
+			m_flags |= FLAG_HAS_LINE_OF_SIGHT;
+		}
+		else
+		{
+			m_flags &= ~FLAG_HAS_LINE_OF_SIGHT;
+		}
 	}
 
 
-	inline size_t FlowData::getAdjacencyCount() const
+	inline bool FlowData::hasLineOfSight() const
 	{
-		return m_adjacencyCount;
+		return ( m_flags & FLAG_HAS_LINE_OF_SIGHT ) > 0;
 	}
 
 
-	inline void FlowData::addAdjacency( CardinalDirection direction )
+	inline void FlowData::setBestAdjacency( CardinalDirection direction )
 	{
-		// We should never add an adjacency twice.
-		promises( !hasAdjacency( direction ) );
+		// Replace the direction bits, keeping the flags.
+		m_flags = (unsigned char) ( ( m_flags & ~FLAG_DIRECTION_MASK ) | (unsigned char) direction );
+	}
+
 
-		// Add the adjacency to the list of adjacencies.
-		m_adjacencies[ (size_t) m_adjacencyCount ] = (unsigned char) direction;
-		++m_adjacencyCount;
+	inline CardinalDirection FlowData::getBestAdjacency() const
+	{
+		return (CardinalDirection) ( m_flags & FLAG_DIRECTION_MASK );
 	}
 
 
-	inline CardinalDirection FlowData::getAdjacency( size_t index ) const
+	inline bool FlowData::operator==( const FlowData& other ) const
 	{
-		CardinalDirection result = CARDINAL_DIRECTION_NONE;
+		return ( m_flags == other.m_flags );
+	}
 
-		if( index < (size_t) m_adjacencyCount )
-		{
-			result = (CardinalDirection) m_adjacencies[ index ];
-		}
 
-		return result;
+	inline bool FlowData::operator!=( const FlowData& other ) const
+	{
+		return ( m_flags != other.m_flags );
 	}
 
 
-	inline CardinalDirection FlowData::getBestAdjacency() const
+	// ------------------------------ Flowfield ------------------------------
+
+	inline Flowfield::Statistics::Statistics() :
+		tilesExpanded( 0 ),
+		queueOperations( 0 )
+	{ }
+
+
+	inline unsigned int Flowfield::getDistanceToGoal( const ConstTile& tile ) const
+	{
+		// Tiles that were never reached have no distance.
+		return ( tile->isClosed() ? m_distancesToGoal[ getTileIndex( tile.getPosition() ) ] : 0 );
+	}
+
+
+	inline void Flowfield::setDistanceToGoal( const Tile& tile, unsigned int distance )
+	{
+		m_distancesToGoal[ getTileIndex( tile.getPosition() ) ] = distance;
+	}
+
+
+	inline unsigned int Flowfield::getTileCost( const TileVector& position ) const
 	{
-		// Return the first (best) direction from this tile.
-		return getAdjacency( 0 );
+		// Only read from the Map, since this may be running on the worker thread.
+		const Map* map = m_map;
+		return map->getTile( position.x, position.y )->getCost();
 	}
 
 
-	inline bool FlowData::hasAdjacency( CardinalDirection direction ) const
+	inline unsigned int Flowfield::getStepCost( const TileVector& position, CardinalDirection direction ) const
+	{
+		// The cost of stepping onto the tile at the given position, from the neighbor in the opposite direction.
+		unsigned int result = getTileCost( position );
+
+		if( m_isOctile )
+		{
+			result *= ( isDiagonalDirection( direction ) ? OCTILE_DIAGONAL_STEP_COST : OCTILE_STRAIGHT_STEP_COST );
+		}
+
+		return result;
+	}
+
+
+	inline bool Flowfield::cutsCorner( const TileVector& position, CardinalDirection direction ) const
 	{
 		bool result = false;
 
-		for( size_t i = 0; i < (size_t) m_adjacencyCount; ++i )
+		if( isDiagonalDirection( direction ) )
 		{
-			if( (CardinalDirection) m_adjacencies[ i ] == direction )
-			{
-				result = true;
-				break;
-			}
+			// A diagonal step passes between the two tiles beside it, so both have to be passable.
+			// Only read from the Map, since this may be running on the worker thread.
+			TileVector adjacentPosition = ( position + getDirectionVector( direction ) );
+			requires( contains( position ) && contains( adjacentPosition ) );
+
+			const Map* map = m_map;
+			result = ( !map->getTile( adjacentPosition.x, position.y )->isPassable() || !map->getTile( position.x, adjacentPosition.y )->isPassable() );
 		}
 
 		return result;
 	}
 
 
-	inline void FlowData::setDistanceToGoal( unsigned int distance )
+	inline size_t Flowfield::getDirectionCount() const
 	{
-		m_distanceToGoal = distance;
+		return ( m_isOctile ? OCTILE_DIRECTION_COUNT : CARDINAL_DIRECTION_COUNT );
 	}
 
 
-	inline unsigned int FlowData::getDistanceToGoal() const
+	inline CardinalDirection Flowfield::getNextDirection( CardinalDirection direction ) const
 	{
-		return m_distanceToGoal;
+		// Visit every neighbor (diagonals too, for octile flowfields) counter-clockwise.
+		return ( m_isOctile ? getCounterClockwiseOctileDirection( direction ) : getCounterClockwiseDirection( direction ) );
 	}
 
 
-	// ------------------------------ Flowfield ------------------------------
+	inline Flowfield::Status Flowfield::getStatus() const
+	{
+		return m_status.load( std::memory_order_acquire );
+	}
+
+
+	inline bool Flowfield::isReady() const
+	{
+		// Reading the status acquires everything written before the Flowfield was published.
+		return ( getStatus() == STATUS_READY );
+	}
+
+
+	inline bool Flowfield::isTileFinal( const ConstTile& tile ) const
+	{
+		// Tiles are only reached once their shortest distance to the goal is known, so while the
+		// Flowfield is being built a slice at a time, every tile reached so far can be read.
+		Status status = getStatus();
+		return ( status == STATUS_READY || ( status == STATUS_PARTIAL && tile->isClosed() ) );
+	}
+
+
+	inline bool Flowfield::hasLineOfSight( const ConstTile& tile, float radius ) const
+	{
+		// Lines of sight are found before any tiles are reached, so they can be read as soon as the Flowfield can.
+		// They only hold for things no wider than the radius they were found for.
+		Status status = getStatus();
+		return ( ( status == STATUS_READY || status == STATUS_PARTIAL ) && radius <= m_lineOfSightRadius && tile->hasLineOfSight() );
+	}
+
+
+	inline float Flowfield::getLineOfSightRadius() const
+	{
+		return m_lineOfSightRadius;
+	}
+
+
+	inline bool Flowfield::isVectorFieldEnabled() const
+	{
+		return m_isVectorFieldEnabled;
+	}
+
+
+	inline bool Flowfield::hasVectorField() const
+	{
+		// The vector field is found once the whole Flowfield has been built, so it can't be read while it's rebuilt.
+		return ( isReady() && !m_fieldVectors.empty() );
+	}
+
+
+	inline void Flowfield::setStatus( Status status )
+	{
+		m_status.store( status, std::memory_order_release );
+	}
+
+
+	inline bool Flowfield::isHierarchical() const
+	{
+		return m_isHierarchical;
+	}
+
+
+	inline bool Flowfield::isOctile() const
+	{
+		return m_isOctile;
+	}
+
+
+	inline bool Flowfield::isCompressed() const
+	{
+		return m_isCompressed;
+	}
+
+
+	inline FlowData Flowfield::getCompressedFlow( const TileVector& position ) const
+	{
+		const FlowRun& run = findCompressedRun( position );
+		return run.flows[ ( position.x - run.x ) & 1 ];
+	}
+
+
+	inline unsigned int Flowfield::getCompressedDistanceToGoal( const TileVector& position ) const
+	{
+		// Like getDistanceToGoal(), this is only valid for closed tiles.
+		const FlowRun& run = findCompressedRun( position );
+		return (unsigned int) ( (int) run.distanceToGoal + ( run.distanceStep * ( position.x - run.x ) ) );
+	}
+
+
+	inline bool Flowfield::isSectorLoaded( size_t sector ) const
+	{
+		return m_loadedSectors[ sector ];
+	}
+
+
+	inline size_t Flowfield::getLoadedSectorCount() const
+	{
+		return m_loadedSectorCount;
+	}
+
+
+	inline void Flowfield::setIntegrationMethod( IntegrationMethod method )
+	{
+		m_integrationMethod = method;
+	}
+
+
+	inline Flowfield::IntegrationMethod Flowfield::getIntegrationMethod() const
+	{
+		return m_integrationMethod;
+	}
+
+
+	inline const Flowfield::Statistics& Flowfield::getStatistics() const
+	{
+		return m_statistics;
+	}
+
 
-	inline void Flowfield::reserve()
+	inline bool Flowfield::isShared() const
 	{
-		m_isReserved = true;
+		return m_isShared;
 	}
 
 
-	inline void Flowfield::release()
+	inline size_t Flowfield::getReferenceCount() const
 	{
-		m_isReserved = false;
+		return m_referenceCount;
 	}
 
 
-	inline bool Flowfield::isReserved() const
+	inline void Flowfield::addReference()
 	{
-		return m_isReserved;
+		++m_referenceCount;
 	}
 
 
-	inline bool Flowfield::isAvailable() const
+	inline void Flowfield::removeReference()
 	{
-		return !m_isReserved;
+		requires( m_referenceCount > 0 );
+		--m_referenceCount;
 	}
 }
 
@@ -0,0 +1,42 @@
+#ifndef ATC_FLOWFIELDWORKER_H
+#define ATC_FLOWFIELDWORKER_H
+
+namespace atc
+{
+	class Flowfield;
+
+	/**
+	 * Recalculates Flowfields on a background thread, one at a time, in the
+	 * order they were submitted. Each Flowfield is only published (marked
+	 * ready) once it has been completely rebuilt.
+	 */
+	class FlowfieldWorker
+	{
+	public:
+		FlowfieldWorker();
+		~FlowfieldWorker();
+
+		void submit( Flowfield* flowfield );
+		void cancel( Flowfield* flowfield );
+		void waitUntilIdle();
+		void stop();
+
+		size_t getPendingJobCount() const;
+		bool isIdle() const;
+		bool isRunning() const;
+
+	protected:
+		void start();
+		void run();
+
+		std::thread m_thread;
+		mutable std::mutex m_mutex;
+		std::condition_variable m_jobSubmitted;
+		std::condition_variable m_jobFinished;
+		std::deque< Flowfield* > m_jobs;
+		Flowfield* m_currentJob;
+		bool m_isStopping;
+	};
+}
+
+#endif
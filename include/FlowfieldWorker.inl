@@ -0,0 +1,19 @@
+#ifndef ATC_FLOWFIELDWORKER_INL
+#define ATC_FLOWFIELDWORKER_INL
+
+namespace atc
+{
+	inline size_t FlowfieldWorker::getPendingJobCount() const
+	{
+		std::lock_guard< std::mutex > lock( m_mutex );
+		return ( m_jobs.size() + ( m_currentJob != nullptr ? 1 : 0 ) );
+	}
+
+
+	inline bool FlowfieldWorker::isRunning() const
+	{
+		return m_thread.joinable();
+	}
+}
+
+#endif
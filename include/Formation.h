@@ -14,7 +14,9 @@ namespace atc
 		static Color getColorByIndex( int index );
 
 		void update( double elapsedTime );
+#ifndef ATC_HEADLESS
 		void draw( Renderer* renderer );
+#endif
 
 		void setBehavior( FormationBehavior* behavior );
 		FormationBehavior* getBehavior() const;
@@ -33,6 +35,7 @@ namespace atc
 		int getFirstFreeSlotIndex() const;
 		Point getSlotOffset( int index ) const;
 		Point getSlotWorldLocation( int index ) const;
+		Point getSlotDestination( int index ) const;
 		Point getRelativePosition( const Point& worldPosition ) const;
 		float calculateCohesion() const;
 		float getAssignUnitToSlotDistance() const;
@@ -49,7 +52,7 @@ namespace atc
 		Point getOrigin() const;
 		Angle getFacingAngle() const;
 		Direction getFacing() const;
-		Flowfield* getFlowfield() const;
+		const Flowfield* getFlowfield() const;
 		bool hasFlowfield() const;
 
 	protected:
@@ -86,8 +89,11 @@ namespace atc
 
 		void recalculate();
 		void reassignSlots();
+		void updateFlowfield();
+		void loadFlowfieldSectors();
 
 		bool m_wasModified;
+		bool m_hasLoadedFlowfieldRoute;
 		int m_index;
 		World* m_world;
 		FormationBehavior* m_behavior;
@@ -98,6 +104,8 @@ namespace atc
 		Angle m_facingAngle;
 		UnitSelection m_units;
 		std::vector< Slot > m_slots;
+		Angle m_arrivalFacingAngle; // The way the Formation faced when it was ordered, which its footprint at the destination is laid out by.
+		std::vector< size_t > m_flowfieldGoalRegion; // Indices of the tiles in the footprint the Flowfield was acquired for.
 
 		friend class World;
 		friend class FormationBehavior;
@@ -117,7 +117,7 @@ namespace atc
 	}
 
 
-	inline Flowfield* Formation::getFlowfield() const
+	inline const Flowfield* Formation::getFlowfield() const
 	{
 		return m_flowfield;
 	}
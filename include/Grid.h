@@ -11,7 +11,8 @@
 namespace atc
 {
 	/**
-	 * Represents a grid direction (i.e. north, south, east, or west).
+	 * Represents a grid direction (i.e. north, south, east, or west), or
+	 * one of the diagonals between them for octile searches.
 	 */
 	enum CardinalDirection
 	{
@@ -19,19 +20,27 @@ namespace atc
 		CARDINAL_DIRECTION_EAST,
 		CARDINAL_DIRECTION_NORTH,
 		CARDINAL_DIRECTION_WEST,
-		CARDINAL_DIRECTION_SOUTH
+		CARDINAL_DIRECTION_SOUTH,
+		CARDINAL_DIRECTION_NORTHEAST,
+		CARDINAL_DIRECTION_NORTHWEST,
+		CARDINAL_DIRECTION_SOUTHWEST,
+		CARDINAL_DIRECTION_SOUTHEAST
 	};
 
 	const size_t CARDINAL_DIRECTION_COUNT = 4;
+	const size_t OCTILE_DIRECTION_COUNT = 8;
 
 
 	CardinalDirection getOppositeDirection( CardinalDirection direction );
 	CardinalDirection getCounterClockwiseDirection( CardinalDirection direction );
+	CardinalDirection getCounterClockwiseOctileDirection( CardinalDirection direction );
+	bool isDiagonalDirection( CardinalDirection direction );
 
 
 	/**
 	 * Data structure that compactly stores a grid of square tiles and
-	 * provides random access to tiles by row and column.
+	 * provides random access to tiles by row and column. Storage is
+	 * allocated for exactly width * height tiles when the grid is resized.
 	 */
 	template< typename tileData_t,
 			  typename tileOffset_t = short,
@@ -92,6 +101,8 @@ namespace atc
 			BasicTile( const BasicTile< false >& other );
 			~BasicTile();
 
+			TileType& operator=( const BasicTile< false >& other );
+
 			TileGridType* getGrid() const;
 			TileDataType& getData() const;
 			TileDataType& operator*() const;
@@ -115,7 +126,7 @@ namespace atc
 			TileGridType* m_grid;
 			TileVector m_position;
 
-			friend class BasicTile;
+			template< bool > friend class BasicTile;
 		};
 
 		typedef BasicTile< false > Tile;
@@ -131,6 +142,8 @@ namespace atc
 		void resize( size_t width, size_t height );
 		void clear( const TileData& fillTile = TileData() );
 		bool contains( const TileVector& position ) const;
+		size_t getTileIndex( const TileVector& position ) const;
+		TileVector getTilePosition( size_t index ) const;
 		Tile getTile( TileOffset x, TileOffset y );
 		ConstTile getTile( TileOffset x, TileOffset y ) const;
 		Tile getTile( const TileVector& position );
@@ -140,9 +153,12 @@ namespace atc
 		size_t getHeight() const;
 
 	protected:
+		const TileData& getTileData( size_t index ) const;
+		TileData& getTileData( size_t index );
+
 		size_t m_width;
 		size_t m_height;
-		TileData m_tiles[ MAX_TILES ];
+		std::vector< TileData > m_tiles;
 	};
 }
 
@@ -41,6 +41,22 @@ namespace atc
 		case CARDINAL_DIRECTION_SOUTH:
 			result = CARDINAL_DIRECTION_NORTH;
 			break;
+
+		case CARDINAL_DIRECTION_NORTHEAST:
+			result = CARDINAL_DIRECTION_SOUTHWEST;
+			break;
+
+		case CARDINAL_DIRECTION_NORTHWEST:
+			result = CARDINAL_DIRECTION_SOUTHEAST;
+			break;
+
+		case CARDINAL_DIRECTION_SOUTHWEST:
+			result = CARDINAL_DIRECTION_NORTHEAST;
+			break;
+
+		case CARDINAL_DIRECTION_SOUTHEAST:
+			result = CARDINAL_DIRECTION_NORTHWEST;
+			break;
 		}
 
 		return result;
@@ -49,6 +65,7 @@ namespace atc
 
 	inline CardinalDirection getCounterClockwiseDirection( CardinalDirection direction )
 	{
+		// Turn a quarter circle, so diagonals stay diagonal.
 		CardinalDirection result = CARDINAL_DIRECTION_NONE;
 
 		switch( direction )
@@ -68,12 +85,78 @@ namespace atc
 		case CARDINAL_DIRECTION_SOUTH:
 			result = CARDINAL_DIRECTION_EAST;
 			break;
+
+		case CARDINAL_DIRECTION_NORTHEAST:
+			result = CARDINAL_DIRECTION_NORTHWEST;
+			break;
+
+		case CARDINAL_DIRECTION_NORTHWEST:
+			result = CARDINAL_DIRECTION_SOUTHWEST;
+			break;
+
+		case CARDINAL_DIRECTION_SOUTHWEST:
+			result = CARDINAL_DIRECTION_SOUTHEAST;
+			break;
+
+		case CARDINAL_DIRECTION_SOUTHEAST:
+			result = CARDINAL_DIRECTION_NORTHEAST;
+			break;
+		}
+
+		return result;
+	}
+
+
+	inline CardinalDirection getCounterClockwiseOctileDirection( CardinalDirection direction )
+	{
+		// Turn an eighth of a circle, alternating between straight and diagonal directions.
+		CardinalDirection result = CARDINAL_DIRECTION_NONE;
+
+		switch( direction )
+		{
+		case CARDINAL_DIRECTION_EAST:
+			result = CARDINAL_DIRECTION_NORTHEAST;
+			break;
+
+		case CARDINAL_DIRECTION_NORTHEAST:
+			result = CARDINAL_DIRECTION_NORTH;
+			break;
+
+		case CARDINAL_DIRECTION_NORTH:
+			result = CARDINAL_DIRECTION_NORTHWEST;
+			break;
+
+		case CARDINAL_DIRECTION_NORTHWEST:
+			result = CARDINAL_DIRECTION_WEST;
+			break;
+
+		case CARDINAL_DIRECTION_WEST:
+			result = CARDINAL_DIRECTION_SOUTHWEST;
+			break;
+
+		case CARDINAL_DIRECTION_SOUTHWEST:
+			result = CARDINAL_DIRECTION_SOUTH;
+			break;
+
+		case CARDINAL_DIRECTION_SOUTH:
+			result = CARDINAL_DIRECTION_SOUTHEAST;
+			break;
+
+		case CARDINAL_DIRECTION_SOUTHEAST:
+			result = CARDINAL_DIRECTION_EAST;
+			break;
 		}
 
 		return result;
 	}
 
 
+	inline bool isDiagonalDirection( CardinalDirection direction )
+	{
+		return ( direction >= CARDINAL_DIRECTION_NORTHEAST );
+	}
+
+
 	// ------------------------------ TileVector ------------------------------
 
 	ATC_GRID_TEMPLATE
@@ -173,6 +256,15 @@ namespace atc
 	ATC_GRID_BASIC_TILE::~BasicTile() { }
 
 
+	ATC_GRID_TILE_TEMPLATE
+	typename ATC_GRID_BASIC_TILE::TileType& ATC_GRID_BASIC_TILE::operator=( const BasicTile< false >& other )
+	{
+		m_grid = other.m_grid;
+		m_position = other.m_position;
+		return *this;
+	}
+
+
 	ATC_GRID_TILE_TEMPLATE
 	typename ATC_GRID_BASIC_TILE::TileGridType* ATC_GRID_BASIC_TILE::getGrid() const
 	{
@@ -184,8 +276,7 @@ namespace atc
 	typename ATC_GRID_BASIC_TILE::TileDataType& ATC_GRID_BASIC_TILE::getData() const
 	{
 		requires( isValid() );
-		size_t index = ( m_position.x + ( m_position.y * GridType::MAX_WIDTH ) );
-		return m_grid->m_tiles[ index ];
+		return m_grid->getTileData( m_grid->getTileIndex( m_position ) );
 	}
 
 
@@ -242,7 +333,7 @@ namespace atc
 
 
 	ATC_GRID_TILE_TEMPLATE
-	typename const ATC_GRID::TileVector& ATC_GRID_BASIC_TILE::getPosition() const
+	const typename ATC_GRID::TileVector& ATC_GRID_BASIC_TILE::getPosition() const
 	{
 		return m_position;
 	}
@@ -280,10 +371,11 @@ namespace atc
 
 	ATC_GRID_TEMPLATE
 	ATC_GRID::Grid( unsigned int width, unsigned int height, const TileData& fillTile ) :
-		m_width( width ),
-		m_height( height )
+		m_width( 0u ),
+		m_height( 0u )
 	{
-		// Fill the grid with the fill tile.
+		// Allocate the grid and fill it with the fill tile.
+		resize( width, height );
 		clear( fillTile );
 	}
 
@@ -314,6 +406,26 @@ namespace atc
 		case CARDINAL_DIRECTION_SOUTH:
 			result.y += 1;
 			break;
+
+		case CARDINAL_DIRECTION_NORTHEAST:
+			result.x += 1;
+			result.y -= 1;
+			break;
+
+		case CARDINAL_DIRECTION_NORTHWEST:
+			result.x -= 1;
+			result.y -= 1;
+			break;
+
+		case CARDINAL_DIRECTION_SOUTHWEST:
+			result.x -= 1;
+			result.y += 1;
+			break;
+
+		case CARDINAL_DIRECTION_SOUTHEAST:
+			result.x += 1;
+			result.y += 1;
+			break;
 		}
 
 		return result;
@@ -326,13 +438,32 @@ namespace atc
 		requires( width <= MAX_WIDTH && height <= MAX_HEIGHT );
 		m_width = width;
 		m_height = height;
+
+		// Allocate storage for exactly as many tiles as the grid holds. Since the stride
+		// changes with the width, existing tile data should be treated as garbage until
+		// the grid is cleared.
+		m_tiles.resize( width * height );
 	}
 
 
 	ATC_GRID_TEMPLATE
 	void ATC_GRID::clear( const TileData& fillTile )
 	{
-		std::fill_n( m_tiles, MAX_TILES, fillTile );
+		std::fill( m_tiles.begin(), m_tiles.end(), fillTile );
+	}
+
+
+	ATC_GRID_TEMPLATE
+	const typename ATC_GRID::TileData& ATC_GRID::getTileData( size_t index ) const
+	{
+		return m_tiles[ index ];
+	}
+
+
+	ATC_GRID_TEMPLATE
+	typename ATC_GRID::TileData& ATC_GRID::getTileData( size_t index )
+	{
+		return m_tiles[ index ];
 	}
 
 
@@ -344,6 +475,21 @@ namespace atc
 	}
 
 
+	ATC_GRID_TEMPLATE
+	size_t ATC_GRID::getTileIndex( const TileVector& position ) const
+	{
+		// Tiles are stored in row-major order.
+		return ( position.x + ( position.y * m_width ) );
+	}
+
+
+	ATC_GRID_TEMPLATE
+	typename ATC_GRID::TileVector ATC_GRID::getTilePosition( size_t index ) const
+	{
+		return TileVector( (TileOffset) ( index % m_width ), (TileOffset) ( index / m_width ) );
+	}
+
+
 	ATC_GRID_TEMPLATE
 	typename ATC_GRID::Tile ATC_GRID::getTile( TileOffset x, TileOffset y )
 	{
@@ -4,15 +4,29 @@
 
 namespace atc
 {
+	class SectorGraph;
+	class CrowdDensity;
+
+
 	class MapTile
 	{
 	public:
+		// The cost of stepping onto a tile, for flowfields and A*. Open ground costs the least.
+		static const unsigned int MIN_COST = 1;
+		static const unsigned int MAX_COST = 16;
+
 		MapTile();
 		~MapTile();
 
 		void setPassable( bool isPassable );
 		bool isPassable() const;
 
+		void setTerrainCost( unsigned int cost );
+		unsigned int getTerrainCost() const;
+		void setCongestionCost( unsigned int cost );
+		unsigned int getCongestionCost() const;
+		unsigned int getCost() const;
+
 		void open( int pathfindIndex );
 		void close( int pathfindIndex );
 
@@ -22,15 +36,17 @@ namespace atc
 		void setLastPathfindDirection( CardinalDirection direction );
 		CardinalDirection getLastPathfindDirection() const;
 
-		void setLastPathfindCost( float cost );
-		float getLastPathfindCost() const;
+		void setLastPathfindCost( unsigned int cost );
+		unsigned int getLastPathfindCost() const;
 
 	protected:
 		bool m_isPassable;
+		unsigned char m_terrainCost;
+		unsigned char m_congestionCost; // (Added by the Map's CrowdDensity, on top of the terrain cost)
 		int m_lastPathfindOpened;
 		int m_lastPathfindClosed;
 		CardinalDirection m_lastPathfindDirection;
-		float m_lastPathfindCost;
+		unsigned int m_lastPathfindCost;
 	};
 
 
@@ -40,20 +56,71 @@ namespace atc
 	class Map : public Grid< MapTile, short, 10 >
 	{
 	public:
-		static const int MAX_FLOWFIELDS = 16;
+		static const size_t MAX_UNUSED_FLOWFIELDS = 64; // (Kept compressed)
+		static const size_t HIERARCHICAL_FLOWFIELD_MIN_TILES = ( 256 * 256 );
 		static const int MAX_PATHFINDS_PER_FRAME = 1;
+		static const size_t FLOWFIELD_SLICE_TILE_COUNT = 1024; // Tiles expanded between checks of the time budget.
+		static const float CONGESTION_UPDATE_INTERVAL; // seconds
+		static const char* FLOWFIELD_FILE_EXTENSION;
+		static const unsigned int NO_COMPONENT = 0; // (The component of impassable tiles)
+		static const int MAX_CLEARANCE = 15; // Wider squares of tiles are checked one tile at a time.
+		static const int MAX_NEAREST_REACHABLE_RADIUS = 64; // tiles
 
 		Map();
 		Map( unsigned int width, unsigned int height, const MapTile& fillTile = MapTile() );
 		~Map();
 
+		void resize( size_t width, size_t height );
+		void clear( const MapTile& fillTile = MapTile() );
 		void update( double elapsedTime );
 
+		void setTilePassable( const TileVector& position, bool isPassable );
+		bool hasPendingTileChanges() const;
+
+		void findComponents();
+		unsigned int getComponent( const TileVector& position );
+		bool isReachable( const TileVector& start, const TileVector& goal );
+		TileVector findNearestReachableTile( const TileVector& start, const TileVector& goal );
+
+		void findClearances();
+		bool hasClearance( const TileVector& position, int radius ) const;
+		bool isAreaPassable( const TileVector& minCorner, const TileVector& maxCorner ) const;
+
 		int requestPathForUnit( Unit* unit, const Point& destination );
 		void cancelPathRequest( int pathIndex );
 
 		Flowfield* createFlowfield();
 		void destroyFlowfield( Flowfield* flowfield );
+		void submitFlowfield( Flowfield* flowfield );
+		void waitForFlowfields();
+
+		void setFlowfieldBuildBudget( size_t maxTilesPerFrame, double maxSecondsPerFrame = 0.0 );
+		bool isBuildingFlowfieldsInSlices() const;
+
+		Flowfield* acquireFlowfield( const TileVector& goalPosition, const std::vector< TileVector >& goalRegion = std::vector< TileVector >() );
+		void releaseFlowfield( Flowfield* flowfield );
+		void clearUnusedFlowfields();
+		size_t getSharedFlowfieldCount() const;
+		size_t getUnusedFlowfieldCount() const;
+
+		void setFlowfieldCacheFolder( const std::string& path );
+		const std::string& getFlowfieldCacheFolder() const;
+		std::string getFlowfieldCachePath( const TileVector& goalPosition, const std::vector< Flowfield::TileVector >& goalRegion, bool isOctile );
+		uint64_t getContentHash();
+
+		const SectorGraph* getSectorGraph();
+		ThreadPool* getThreadPool();
+		bool hasWeightedTiles();
+
+		void setCrowdDensityEnabled( bool isEnabled );
+		bool isCrowdDensityEnabled() const;
+		CrowdDensity* getCrowdDensity();
+
+		void setOctileFlowfieldsEnabled( bool isEnabled );
+		bool areOctileFlowfieldsEnabled() const;
+
+		void setVectorFieldsEnabled( bool isEnabled );
+		bool areVectorFieldsEnabled() const;
 
 		float getLeft() const;
 		float getRight() const;
@@ -73,15 +140,82 @@ namespace atc
 			Point destination;
 		};
 
-		void init();
+		/**
+		 * A change to the passability of a tile, waiting to be applied.
+		 */
+		struct TileChange
+		{
+			TileChange() { }
+			TileChange( const TileVector& position, bool isPassable ) :
+				position( position ), isPassable( isPassable )
+			{ }
+
+			TileVector position;
+			bool isPassable;
+		};
+
 		void findPath();
+		void applyTileChanges();
+		void updateComponents( const TileVector& position );
+		bool mightSplitComponent( const TileVector& position ) const;
+		size_t fillComponent( const TileVector& start, unsigned int component );
+		void relabelTile( size_t index, unsigned int component );
+		unsigned int createComponent();
+		void updateClearances( const TileVector& position );
+		void findClearance( size_t index, const TileVector& position );
+		bool applyCongestionChanges();
+		void buildFlowfieldSlices( size_t maxTileCount, double maxSeconds );
+		void evictFlowfield( Flowfield* flowfield );
+		bool hasCachedFlowfield( const TileVector& goalPosition );
+		bool loadCachedFlowfield( Flowfield* flowfield );
+		std::vector< size_t > getFlowfieldKey( const TileVector& goalPosition, const std::vector< Flowfield::TileVector >& goalRegion ) const;
+		bool ownsFlowfield( const Flowfield* flowfield ) const;
+		static uint64_t getOpenListKey( unsigned int costSoFar, unsigned int distanceToGoal );
 
 		int m_nextPathfindIndex;
-		int m_nextFlowfieldIndex;
 		std::map< int, PathfindRequest > m_pathfindRequestsByIndex;
-		FixedSizeMinHeap< 1024, float, Tile > m_openList;
-		MapTile m_tiles[ MAX_TILES ];
-		Flowfield m_flowfields[ MAX_FLOWFIELDS ];
+		IndexedMinHeap< uint64_t > m_openList; // Tile indices, for A*.
+		std::vector< TileChange > m_pendingTileChanges;
+		std::vector< Flowfield* > m_flowfields;
+		std::map< std::vector< size_t >, Flowfield* > m_sharedFlowfieldsByGoal; // By the index of the goal tile, then those of the goal region.
+		std::deque< Flowfield* > m_unusedFlowfields; // Shared Flowfields with no references, least recently used first.
+		FlowfieldWorker m_flowfieldWorker;
+
+		// With a budget, Flowfields are built a slice per frame on the main thread instead of on the worker.
+		size_t m_flowfieldTileBudget; // (0 for no limit)
+		double m_flowfieldTimeBudget; // seconds (0 for no limit)
+		std::deque< Flowfield* > m_slicedFlowfields; // Waiting to be built, in order. The first is being built.
+		ThreadPool m_threadPool; // Shared by the Flowfields for parallel integration.
+		SectorGraph* m_sectorGraph;
+		bool m_isSectorGraphValid;
+		bool m_hasWeightedTiles; // Whether any passable tile costs more than MapTile::MIN_COST.
+		bool m_isWeightingValid;
+
+		// Crowds add a congestion cost to the tiles they jam, refreshed every CONGESTION_UPDATE_INTERVAL.
+		CrowdDensity* m_crowdDensity;
+		bool m_isCrowdDensityEnabled;
+		double m_timeSinceCongestionUpdate;
+		bool m_areOctileFlowfieldsEnabled; // Whether shared Flowfields also step diagonally (unless they're hierarchical).
+
+		// Shared Flowfields baked ahead of time are loaded from files named after the content of the Map.
+		std::string m_flowfieldCacheFolder; // (Empty for none)
+		uint64_t m_contentHash;
+		bool m_isContentHashValid;
+
+		bool m_areVectorFieldsEnabled; // Whether shared Flowfields are smoothed into vector fields for Units to steer by.
+
+		// Passable tiles are labeled by the area they're connected to, so orders toward places that can't be
+		// reached are caught without a search. Kept up to date as tiles change, once they've been labeled.
+		std::vector< unsigned int > m_componentsByTile;
+		std::vector< size_t > m_componentSizes; // Tiles in each component, by label. (0 for labels not in use)
+		std::vector< unsigned int > m_unusedComponents;
+		std::vector< TileVector > m_componentQueue;
+		bool m_areComponentsValid;
+
+		// The side of the largest square of passable tiles (up to MAX_CLEARANCE) whose lowest corner is each tile, so
+		// whether Units fit somewhere is found without checking every tile around them.
+		std::vector< unsigned char > m_clearances;
+		bool m_areClearancesValid;
 	};
 }
 
@@ -4,9 +4,11 @@ namespace atc
 
 	inline MapTile::MapTile() :
 		m_isPassable( true ),
+		m_terrainCost( MIN_COST ),
+		m_congestionCost( 0 ),
 		m_lastPathfindOpened( -1 ),
 		m_lastPathfindClosed( -1 ),
-		m_lastPathfindCost( 0.0f ),
+		m_lastPathfindCost( 0 ),
 		m_lastPathfindDirection( CARDINAL_DIRECTION_NONE )
 	{ }
 
@@ -26,6 +28,38 @@ namespace atc
 	}
 
 
+	inline void MapTile::setTerrainCost( unsigned int cost )
+	{
+		requires( cost >= MIN_COST && cost <= MAX_COST );
+		m_terrainCost = (unsigned char) cost;
+	}
+
+
+	inline unsigned int MapTile::getTerrainCost() const
+	{
+		return m_terrainCost;
+	}
+
+
+	inline void MapTile::setCongestionCost( unsigned int cost )
+	{
+		requires( cost <= MAX_COST - MIN_COST );
+		m_congestionCost = (unsigned char) cost;
+	}
+
+
+	inline unsigned int MapTile::getCongestionCost() const
+	{
+		return m_congestionCost;
+	}
+
+
+	inline unsigned int MapTile::getCost() const
+	{
+		return std::min< unsigned int >( m_terrainCost + m_congestionCost, MAX_COST );
+	}
+
+
 	inline void MapTile::open( int pathfindIndex )
 	{
 		m_lastPathfindOpened = pathfindIndex;
@@ -62,13 +96,13 @@ namespace atc
 	}
 
 
-	inline void MapTile::setLastPathfindCost( float cost )
+	inline void MapTile::setLastPathfindCost( unsigned int cost )
 	{
 		m_lastPathfindCost = cost;
 	}
 
 
-	inline float MapTile::getLastPathfindCost() const
+	inline unsigned int MapTile::getLastPathfindCost() const
 	{
 		return m_lastPathfindCost;
 	}
@@ -98,4 +132,64 @@ namespace atc
 	{
 		return ( getBottom() + m_height );
 	}
+
+
+	inline size_t Map::getSharedFlowfieldCount() const
+	{
+		return m_sharedFlowfieldsByGoal.size();
+	}
+
+
+	inline size_t Map::getUnusedFlowfieldCount() const
+	{
+		return m_unusedFlowfields.size();
+	}
+
+
+	inline void Map::setFlowfieldCacheFolder( const std::string& path )
+	{
+		m_flowfieldCacheFolder = path;
+	}
+
+
+	inline const std::string& Map::getFlowfieldCacheFolder() const
+	{
+		return m_flowfieldCacheFolder;
+	}
+
+
+	inline bool Map::isBuildingFlowfieldsInSlices() const
+	{
+		return ( m_flowfieldTileBudget > 0 || m_flowfieldTimeBudget > 0.0 );
+	}
+
+
+	inline ThreadPool* Map::getThreadPool()
+	{
+		return &m_threadPool;
+	}
+
+
+	inline bool Map::isCrowdDensityEnabled() const
+	{
+		return m_isCrowdDensityEnabled;
+	}
+
+
+	inline CrowdDensity* Map::getCrowdDensity()
+	{
+		return m_crowdDensity;
+	}
+
+
+	inline bool Map::areOctileFlowfieldsEnabled() const
+	{
+		return m_areOctileFlowfieldsEnabled;
+	}
+
+
+	inline bool Map::areVectorFieldsEnabled() const
+	{
+		return m_areVectorFieldsEnabled;
+	}
 }
\ No newline at end of file
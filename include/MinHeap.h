@@ -71,6 +71,101 @@ namespace atc
 		Pair m_swapPair;
 		Pair m_pairs[ CAPACITY ];
 	};
+
+
+	/**
+	 * Data structure optimized for finding the minimum element in a set,
+	 * with storage that grows as elements are added.
+	 */
+	template< typename key_t, typename value_t >
+	class MinHeap
+	{
+	public:
+		typedef value_t Value;
+		typedef key_t Key;
+
+		MinHeap();
+		~MinHeap();
+
+		void reserve( size_t capacity );
+		void insert( const Key& key, const Value& value );
+		Value popMinElement();
+		Value peekMinElement() const;
+		Key peekMinKey() const;
+		void clear();
+
+		size_t getCapacity() const;
+		size_t getSize() const;
+		bool isEmpty() const;
+
+	protected:
+		struct Pair
+		{
+			Pair();
+			Pair( const Key& key, const Value& value );
+
+			bool operator>( const Pair& other ) const;
+
+			Key key;
+			Value value;
+		};
+
+		void bubbleUp( size_t index );
+		void bubbleDown( size_t index );
+
+		std::vector< Pair > m_pairs;
+	};
+
+
+	/**
+	 * Min-heap of integer handles (e.g. tile indices) that tracks the slot of
+	 * each handle in the heap, so keys can be updated in O(log n) and handles
+	 * can be looked up in O(1).
+	 */
+	template< typename key_t >
+	class IndexedMinHeap
+	{
+	public:
+		typedef key_t Key;
+		typedef size_t Handle;
+
+		static const size_t INVALID_SLOT = ~( (size_t) 0 );
+
+		IndexedMinHeap();
+		~IndexedMinHeap();
+
+		void setHandleCount( size_t handleCount );
+		void insert( const Key& key, Handle handle );
+		void update( const Key& key, Handle handle );
+		Handle popMinElement();
+		Handle peekMinElement() const;
+		void clear();
+
+		bool contains( Handle handle ) const;
+		const Key& getKey( Handle handle ) const;
+		size_t getHandleCount() const;
+		size_t getSize() const;
+		bool isEmpty() const;
+
+	protected:
+		struct Pair
+		{
+			Pair();
+			Pair( const Key& key, Handle handle );
+
+			bool operator>( const Pair& other ) const;
+
+			Key key;
+			Handle handle;
+		};
+
+		void swapSlots( size_t first, size_t second );
+		void bubbleUp( size_t slot );
+		void bubbleDown( size_t slot );
+
+		std::vector< Pair > m_pairs;
+		std::vector< size_t > m_slotsByHandle;
+	};
 }
 
 #endif
\ No newline at end of file
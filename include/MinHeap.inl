@@ -34,8 +34,8 @@ namespace atc
 	FixedSizeMinHeap< capacity, key_t, value_t >::FixedSizeMinHeap() :
 	m_size( 0 )
 	{
-		// Zero out all memory.
-		memset( m_pairs, 0, sizeof( m_pairs ) );
+		// Reset every pair.
+		std::fill( m_pairs, ( m_pairs + capacity ), Pair() );
 	}
 
 
@@ -381,7 +381,7 @@ namespace atc
 	bool FixedSizeMinHeap< capacity, key_t, value_t >::isValidNode( ConstNode node ) const
 	{
 		size_t nodeIndex = getIndexOfNode( node );
-		return ( ( nodeIndex >= 0 ) && ( nodeIndex < m_size ) );
+		return ( nodeIndex < m_size );
 	}
 
 
@@ -398,8 +398,6 @@ namespace atc
 		// Return whether this node is greater than or equal to its parent.
 		if( isValidNode( parentNode ) && ( *parentNode > *node ) )
 		{
-			int parentIndex = getIndexOfNode( parentNode );
-			int nodeIndex = getIndexOfNode( node );
 			return false;
 		}
 
@@ -411,6 +409,412 @@ namespace atc
 
 		return true;
 	}
+
+
+	// ------------------------------ MinHeap ------------------------------
+
+	template< typename key_t, typename value_t >
+	MinHeap< key_t, value_t >::Pair::Pair()
+	{ }
+
+
+	template< typename key_t, typename value_t >
+	MinHeap< key_t, value_t >::Pair::Pair( const Key& key, const Value& value ) :
+		key( key ), value( value )
+	{ }
+
+
+	template< typename key_t, typename value_t >
+	bool MinHeap< key_t, value_t >::Pair::operator>( const Pair& other ) const
+	{
+		// Return whether this Pair has a greater key.
+		return ( key > other.key );
+	}
+
+
+	template< typename key_t, typename value_t >
+	MinHeap< key_t, value_t >::MinHeap()
+	{ }
+
+
+	template< typename key_t, typename value_t >
+	MinHeap< key_t, value_t >::~MinHeap() { }
+
+
+	template< typename key_t, typename value_t >
+	void MinHeap< key_t, value_t >::reserve( size_t capacity )
+	{
+		m_pairs.reserve( capacity );
+	}
+
+
+	template< typename key_t, typename value_t >
+	void MinHeap< key_t, value_t >::insert( const Key& key, const Value& value )
+	{
+		// Add the element to the end of the array and re-balance the tree.
+		m_pairs.push_back( Pair( key, value ) );
+		bubbleUp( m_pairs.size() - 1 );
+	}
+
+
+	template< typename key_t, typename value_t >
+	value_t MinHeap< key_t, value_t >::popMinElement()
+	{
+		requires( !isEmpty() );
+
+		// Copy the value to pop.
+		Value value = m_pairs.front().value;
+
+		// Move the last element to the top of the tree and re-balance it.
+		m_pairs.front() = m_pairs.back();
+		m_pairs.pop_back();
+
+		if( m_pairs.size() > 1 )
+			bubbleDown( 0 );
+
+		// Return the popped value.
+		return value;
+	}
+
+
+	template< typename key_t, typename value_t >
+	value_t MinHeap< key_t, value_t >::peekMinElement() const
+	{
+		requires( !isEmpty() );
+
+		// Return the topmost value.
+		return m_pairs.front().value;
+	}
+
+
+	template< typename key_t, typename value_t >
+	key_t MinHeap< key_t, value_t >::peekMinKey() const
+	{
+		requires( !isEmpty() );
+
+		// Return the topmost key.
+		return m_pairs.front().key;
+	}
+
+
+	template< typename key_t, typename value_t >
+	void MinHeap< key_t, value_t >::clear()
+	{
+		// Remove all elements, but keep the storage for reuse.
+		m_pairs.clear();
+	}
+
+
+	template< typename key_t, typename value_t >
+	size_t MinHeap< key_t, value_t >::getCapacity() const
+	{
+		return m_pairs.capacity();
+	}
+
+
+	template< typename key_t, typename value_t >
+	size_t MinHeap< key_t, value_t >::getSize() const
+	{
+		return m_pairs.size();
+	}
+
+
+	template< typename key_t, typename value_t >
+	bool MinHeap< key_t, value_t >::isEmpty() const
+	{
+		return m_pairs.empty();
+	}
+
+
+	template< typename key_t, typename value_t >
+	void MinHeap< key_t, value_t >::bubbleUp( size_t index )
+	{
+		// Move the node as far up the tree as possible.
+		while( index > 0 )
+		{
+			size_t parentIndex = ( ( index - 1 ) >> 1 );
+
+			if( m_pairs[ parentIndex ] > m_pairs[ index ] )
+			{
+				// If the current node is less than its parent, swap the two.
+				std::swap( m_pairs[ index ], m_pairs[ parentIndex ] );
+
+				// Continue re-balancing from the parent node.
+				index = parentIndex;
+			}
+			else break;
+		}
+	}
+
+
+	template< typename key_t, typename value_t >
+	void MinHeap< key_t, value_t >::bubbleDown( size_t index )
+	{
+		size_t size = m_pairs.size();
+
+		// Move the node as far down the tree as necessary.
+		while( true )
+		{
+			size_t firstChildIndex = ( ( index << 1 ) + 1 );
+			size_t secondChildIndex = ( firstChildIndex + 1 );
+
+			if( firstChildIndex >= size )
+			{
+				// If this node is a leaf, stop bubbling.
+				break;
+			}
+
+			// Check the smaller of the two children.
+			size_t indexToCheck = firstChildIndex;
+
+			if( secondChildIndex < size && ( m_pairs[ firstChildIndex ] > m_pairs[ secondChildIndex ] ) )
+			{
+				indexToCheck = secondChildIndex;
+			}
+
+			if( m_pairs[ index ] > m_pairs[ indexToCheck ] )
+			{
+				// If the chosen child node is less than its parent, swap the two.
+				std::swap( m_pairs[ index ], m_pairs[ indexToCheck ] );
+
+				// Continue re-balancing from the child node.
+				index = indexToCheck;
+			}
+			else break;
+		}
+	}
+
+
+	// ------------------------------ IndexedMinHeap ------------------------------
+
+	template< typename key_t >
+	const size_t IndexedMinHeap< key_t >::INVALID_SLOT;
+
+
+	template< typename key_t >
+	IndexedMinHeap< key_t >::Pair::Pair() :
+		handle( 0 )
+	{ }
+
+
+	template< typename key_t >
+	IndexedMinHeap< key_t >::Pair::Pair( const Key& key, Handle handle ) :
+		key( key ), handle( handle )
+	{ }
+
+
+	template< typename key_t >
+	bool IndexedMinHeap< key_t >::Pair::operator>( const Pair& other ) const
+	{
+		// Return whether this Pair has a greater key.
+		return ( key > other.key );
+	}
+
+
+	template< typename key_t >
+	IndexedMinHeap< key_t >::IndexedMinHeap()
+	{ }
+
+
+	template< typename key_t >
+	IndexedMinHeap< key_t >::~IndexedMinHeap() { }
+
+
+	template< typename key_t >
+	void IndexedMinHeap< key_t >::setHandleCount( size_t handleCount )
+	{
+		// Handles are indices into the slot table, so the heap must be empty to resize it.
+		requires( isEmpty() );
+		m_slotsByHandle.assign( handleCount, INVALID_SLOT );
+	}
+
+
+	template< typename key_t >
+	void IndexedMinHeap< key_t >::insert( const Key& key, Handle handle )
+	{
+		requires( handle < m_slotsByHandle.size() );
+		requires( !contains( handle ) );
+
+		// Add the element to the end of the array and re-balance the tree.
+		m_slotsByHandle[ handle ] = m_pairs.size();
+		m_pairs.push_back( Pair( key, handle ) );
+		bubbleUp( m_pairs.size() - 1 );
+	}
+
+
+	template< typename key_t >
+	void IndexedMinHeap< key_t >::update( const Key& key, Handle handle )
+	{
+		requires( contains( handle ) );
+
+		// Change the key in place, then bubble the node up or down as necessary.
+		size_t slot = m_slotsByHandle[ handle ];
+		Key oldKey = m_pairs[ slot ].key;
+		m_pairs[ slot ].key = key;
+
+		if( oldKey > key )
+		{
+			bubbleUp( slot );
+		}
+		else
+		{
+			bubbleDown( slot );
+		}
+	}
+
+
+	template< typename key_t >
+	typename IndexedMinHeap< key_t >::Handle IndexedMinHeap< key_t >::popMinElement()
+	{
+		requires( !isEmpty() );
+
+		// Copy the handle to pop, and forget its slot.
+		Handle handle = m_pairs.front().handle;
+		m_slotsByHandle[ handle ] = INVALID_SLOT;
+
+		// Move the last element to the top of the tree and re-balance it.
+		if( m_pairs.size() > 1 )
+		{
+			m_pairs.front() = m_pairs.back();
+			m_slotsByHandle[ m_pairs.front().handle ] = 0;
+		}
+
+		m_pairs.pop_back();
+
+		if( m_pairs.size() > 1 )
+			bubbleDown( 0 );
+
+		// Return the popped handle.
+		return handle;
+	}
+
+
+	template< typename key_t >
+	typename IndexedMinHeap< key_t >::Handle IndexedMinHeap< key_t >::peekMinElement() const
+	{
+		requires( !isEmpty() );
+
+		// Return the topmost handle.
+		return m_pairs.front().handle;
+	}
+
+
+	template< typename key_t >
+	void IndexedMinHeap< key_t >::clear()
+	{
+		// Forget the slots of the remaining elements only, so clearing is O(size) rather than O(handle count).
+		for( const Pair& pair : m_pairs )
+		{
+			m_slotsByHandle[ pair.handle ] = INVALID_SLOT;
+		}
+
+		m_pairs.clear();
+	}
+
+
+	template< typename key_t >
+	bool IndexedMinHeap< key_t >::contains( Handle handle ) const
+	{
+		return ( handle < m_slotsByHandle.size() && m_slotsByHandle[ handle ] != INVALID_SLOT );
+	}
+
+
+	template< typename key_t >
+	const typename IndexedMinHeap< key_t >::Key& IndexedMinHeap< key_t >::getKey( Handle handle ) const
+	{
+		requires( contains( handle ) );
+		return m_pairs[ m_slotsByHandle[ handle ] ].key;
+	}
+
+
+	template< typename key_t >
+	size_t IndexedMinHeap< key_t >::getHandleCount() const
+	{
+		return m_slotsByHandle.size();
+	}
+
+
+	template< typename key_t >
+	size_t IndexedMinHeap< key_t >::getSize() const
+	{
+		return m_pairs.size();
+	}
+
+
+	template< typename key_t >
+	bool IndexedMinHeap< key_t >::isEmpty() const
+	{
+		return m_pairs.empty();
+	}
+
+
+	template< typename key_t >
+	void IndexedMinHeap< key_t >::swapSlots( size_t first, size_t second )
+	{
+		// Swap the two elements, and keep the slot table pointing at them.
+		std::swap( m_pairs[ first ], m_pairs[ second ] );
+		m_slotsByHandle[ m_pairs[ first ].handle ] = first;
+		m_slotsByHandle[ m_pairs[ second ].handle ] = second;
+	}
+
+
+	template< typename key_t >
+	void IndexedMinHeap< key_t >::bubbleUp( size_t slot )
+	{
+		// Move the node as far up the tree as possible.
+		while( slot > 0 )
+		{
+			size_t parentSlot = ( ( slot - 1 ) >> 1 );
+
+			if( m_pairs[ parentSlot ] > m_pairs[ slot ] )
+			{
+				// If the current node is less than its parent, swap the two.
+				swapSlots( slot, parentSlot );
+
+				// Continue re-balancing from the parent node.
+				slot = parentSlot;
+			}
+			else break;
+		}
+	}
+
+
+	template< typename key_t >
+	void IndexedMinHeap< key_t >::bubbleDown( size_t slot )
+	{
+		size_t size = m_pairs.size();
+
+		// Move the node as far down the tree as necessary.
+		while( true )
+		{
+			size_t firstChildSlot = ( ( slot << 1 ) + 1 );
+			size_t secondChildSlot = ( firstChildSlot + 1 );
+
+			if( firstChildSlot >= size )
+			{
+				// If this node is a leaf, stop bubbling.
+				break;
+			}
+
+			// Check the smaller of the two children.
+			size_t slotToCheck = firstChildSlot;
+
+			if( secondChildSlot < size && ( m_pairs[ firstChildSlot ] > m_pairs[ secondChildSlot ] ) )
+			{
+				slotToCheck = secondChildSlot;
+			}
+
+			if( m_pairs[ slot ] > m_pairs[ slotToCheck ] )
+			{
+				// If the chosen child node is less than its parent, swap the two.
+				swapSlots( slot, slotToCheck );
+
+				// Continue re-balancing from the child node.
+				slot = slotToCheck;
+			}
+			else break;
+		}
+	}
 }
 
 #endif
\ No newline at end of file
@@ -14,7 +14,9 @@ namespace atc
 		Path( Unit* unit, const Point& destination );
 		~Path();
 
+#ifndef ATC_HEADLESS
 		void draw( Renderer* renderer );
+#endif
 
 		void clear();
 		void pushWaypoint( const Point& waypoint );
@@ -0,0 +1,88 @@
+#ifndef ATC_SECTORGRAPH_H
+#define ATC_SECTORGRAPH_H
+
+namespace atc
+{
+	/**
+	 * Splits a Map into square sectors, and connects the sectors through
+	 * portals (runs of passable tiles along the border between two sectors).
+	 * Searching this graph of portals gives the approximate distance to a
+	 * goal from every sector, without visiting every tile of the Map.
+	 */
+	class SectorGraph
+	{
+	public:
+		typedef Map::TileVector TileVector;
+
+		static const int SECTOR_SIZE = 16;
+		static const size_t SECTOR_TILE_COUNT = ( SECTOR_SIZE * SECTOR_SIZE );
+		static const unsigned int UNREACHABLE = UINT_MAX;
+
+		/**
+		 * A run of passable tile pairs joining two adjacent sectors.
+		 * Side 0 is the west (or north) sector and side 1 is the east (or south) sector.
+		 */
+		struct Portal
+		{
+			TileVector getTile( size_t side, size_t offset ) const;
+			TileVector getCenter( size_t side ) const;
+			size_t getCenterOffset() const;
+
+			TileVector start[ 2 ];
+			TileVector step;
+			CardinalDirection crossing; // (From side 0 to side 1)
+			size_t length;
+			size_t sectors[ 2 ];
+		};
+
+		/**
+		 * A weighted link between two portal nodes.
+		 */
+		struct Edge
+		{
+			size_t node;
+			unsigned int cost;
+		};
+
+		SectorGraph();
+		~SectorGraph();
+
+		static size_t getNode( size_t portalIndex, size_t side );
+		static size_t getPortalIndex( size_t node );
+		static size_t getSide( size_t node );
+
+		void rebuild( const Map* map );
+		void findSectorDistances( size_t sector, const TileVector& source, std::vector< unsigned int >& distances ) const;
+
+		size_t getSectorIndex( const TileVector& position ) const;
+		TileVector getSectorOrigin( size_t sector ) const;
+		TileVector getSectorSize( size_t sector ) const;
+		size_t getLocalTileIndex( size_t sector, const TileVector& position ) const;
+		bool sectorContains( size_t sector, const TileVector& position ) const;
+		size_t getSectorCount() const;
+		size_t getSectorsWide() const;
+		size_t getSectorsHigh() const;
+
+		const Portal& getPortal( size_t portalIndex ) const;
+		size_t getPortalCount() const;
+		size_t getNodeCount() const;
+		const std::vector< size_t >& getSectorPortals( size_t sector ) const;
+		const std::vector< Edge >& getNodeEdges( size_t node ) const;
+		size_t getSideInSector( size_t portalIndex, size_t sector ) const;
+
+	protected:
+		void addPortals( const TileVector& firstStart, const TileVector& step, const TileVector& across, CardinalDirection crossing, size_t length );
+		void addPortal( const TileVector& start, const TileVector& step, const TileVector& across, CardinalDirection crossing, size_t length );
+		void connectSectorPortals( size_t sector, BucketQueue< TileVector >& tilesToEvaluate );
+		void findSectorDistances( size_t sector, const TileVector& source, std::vector< unsigned int >& distances, BucketQueue< TileVector >& tilesToEvaluate ) const;
+
+		const Map* m_map;
+		size_t m_sectorsWide;
+		size_t m_sectorsHigh;
+		std::vector< Portal > m_portals;
+		std::vector< std::vector< size_t > > m_portalsBySector;
+		std::vector< std::vector< Edge > > m_edgesByNode;
+	};
+}
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef ATC_SECTORGRAPH_INL
+#define ATC_SECTORGRAPH_INL
+
+namespace atc
+{
+	// ------------------------------ Portal ------------------------------
+
+	inline SectorGraph::TileVector SectorGraph::Portal::getTile( size_t side, size_t offset ) const
+	{
+		return TileVector( start[ side ].x + (Map::TileOffset) ( step.x * offset ), start[ side ].y + (Map::TileOffset) ( step.y * offset ) );
+	}
+
+
+	inline SectorGraph::TileVector SectorGraph::Portal::getCenter( size_t side ) const
+	{
+		return getTile( side, getCenterOffset() );
+	}
+
+
+	inline size_t SectorGraph::Portal::getCenterOffset() const
+	{
+		return ( length / 2 );
+	}
+
+
+	// ------------------------------ SectorGraph ------------------------------
+
+	inline size_t SectorGraph::getNode( size_t portalIndex, size_t side )
+	{
+		// Each portal has one node on either side.
+		return ( ( portalIndex << 1 ) | side );
+	}
+
+
+	inline size_t SectorGraph::getPortalIndex( size_t node )
+	{
+		return ( node >> 1 );
+	}
+
+
+	inline size_t SectorGraph::getSide( size_t node )
+	{
+		return ( node & 1 );
+	}
+
+
+	inline size_t SectorGraph::getSectorIndex( const TileVector& position ) const
+	{
+		return ( ( position.x / SECTOR_SIZE ) + ( ( position.y / SECTOR_SIZE ) * m_sectorsWide ) );
+	}
+
+
+	inline SectorGraph::TileVector SectorGraph::getSectorOrigin( size_t sector ) const
+	{
+		return TileVector( (Map::TileOffset) ( ( sector % m_sectorsWide ) * SECTOR_SIZE ), (Map::TileOffset) ( ( sector / m_sectorsWide ) * SECTOR_SIZE ) );
+	}
+
+
+	inline SectorGraph::TileVector SectorGraph::getSectorSize( size_t sector ) const
+	{
+		// Sectors along the right and bottom edges are cut off by the edge of the Map.
+		TileVector origin = getSectorOrigin( sector );
+		return TileVector( (Map::TileOffset) std::min< size_t >( SECTOR_SIZE, m_map->getWidth() - origin.x ),
+						   (Map::TileOffset) std::min< size_t >( SECTOR_SIZE, m_map->getHeight() - origin.y ) );
+	}
+
+
+	inline size_t SectorGraph::getLocalTileIndex( size_t sector, const TileVector& position ) const
+	{
+		TileVector offset = ( position - getSectorOrigin( sector ) );
+		return ( offset.x + ( offset.y * SECTOR_SIZE ) );
+	}
+
+
+	inline bool SectorGraph::sectorContains( size_t sector, const TileVector& position ) const
+	{
+		TileVector offset = ( position - getSectorOrigin( sector ) );
+		TileVector size = getSectorSize( sector );
+		return ( offset.x >= 0 && offset.y >= 0 && offset.x < size.x && offset.y < size.y );
+	}
+
+
+	inline size_t SectorGraph::getSectorCount() const
+	{
+		return ( m_sectorsWide * m_sectorsHigh );
+	}
+
+
+	inline size_t SectorGraph::getSectorsWide() const
+	{
+		return m_sectorsWide;
+	}
+
+
+	inline size_t SectorGraph::getSectorsHigh() const
+	{
+		return m_sectorsHigh;
+	}
+
+
+	inline const SectorGraph::Portal& SectorGraph::getPortal( size_t portalIndex ) const
+	{
+		return m_portals[ portalIndex ];
+	}
+
+
+	inline size_t SectorGraph::getPortalCount() const
+	{
+		return m_portals.size();
+	}
+
+
+	inline size_t SectorGraph::getNodeCount() const
+	{
+		return ( m_portals.size() * 2 );
+	}
+
+
+	inline const std::vector< size_t >& SectorGraph::getSectorPortals( size_t sector ) const
+	{
+		return m_portalsBySector[ sector ];
+	}
+
+
+	inline const std::vector< SectorGraph::Edge >& SectorGraph::getNodeEdges( size_t node ) const
+	{
+		return m_edgesByNode[ node ];
+	}
+
+
+	inline size_t SectorGraph::getSideInSector( size_t portalIndex, size_t sector ) const
+	{
+		return ( m_portals[ portalIndex ].sectors[ 0 ] == sector ? 0 : 1 );
+	}
+}
+
+#endif
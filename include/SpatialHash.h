@@ -0,0 +1,36 @@
+#ifndef ATC_SPATIALHASH_H
+#define ATC_SPATIALHASH_H
+
+namespace atc
+{
+	/**
+	 * Buckets Actors by position into a hashed grid of square cells, so that
+	 * Actors near a point can be found without testing every Actor.
+	 */
+	class SpatialHash
+	{
+	public:
+		SpatialHash();
+		~SpatialHash();
+
+		void rebuild( const std::vector< Actor* >& actors, float cellSize );
+		void clear();
+		void findNearbyActors( const Point& position, std::vector< Actor* >& result ) const;
+
+		float getCellSize() const;
+		size_t getActorCount() const;
+
+	protected:
+		int getCellCoordinate( float position ) const;
+		size_t getBucketIndex( int cellX, int cellY ) const;
+
+		float m_cellSize;
+		float m_inverseCellSize;
+		size_t m_bucketMask;
+		std::vector< size_t > m_bucketStarts;
+		std::vector< size_t > m_actorBuckets;
+		std::vector< Actor* > m_actorsByBucket;
+	};
+}
+
+#endif
@@ -0,0 +1,27 @@
+namespace atc
+{
+	inline float SpatialHash::getCellSize() const
+	{
+		return m_cellSize;
+	}
+
+
+	inline size_t SpatialHash::getActorCount() const
+	{
+		return m_actorsByBucket.size();
+	}
+
+
+	inline int SpatialHash::getCellCoordinate( float position ) const
+	{
+		return (int) floorf( position * m_inverseCellSize );
+	}
+
+
+	inline size_t SpatialHash::getBucketIndex( int cellX, int cellY ) const
+	{
+		// Hash the cell coordinates (using large primes) into one of the buckets.
+		size_t hash = ( ( (size_t) cellX * 73856093u ) ^ ( (size_t) cellY * 19349663u ) );
+		return ( hash & m_bucketMask );
+	}
+}
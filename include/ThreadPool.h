@@ -0,0 +1,65 @@
+#ifndef ATC_THREADPOOL_H
+#define ATC_THREADPOOL_H
+
+namespace atc
+{
+	/**
+	 * Runs one task on several threads at once: the calling thread plus a set
+	 * of worker threads that sleep between tasks. Each thread is passed its
+	 * index, so the task can split its work between them.
+	 */
+	class ThreadPool
+	{
+	public:
+		typedef std::function< void( size_t threadIndex ) > Task;
+
+		ThreadPool();
+		~ThreadPool();
+
+		void run( const Task& task );
+		void stop();
+
+		void setThreadCount( size_t threadCount );
+		size_t getThreadCount() const;
+		bool isRunning() const;
+
+	protected:
+		void start();
+		void runWorker( size_t threadIndex, size_t taskGeneration );
+
+		size_t m_threadCount; // (Including the thread that calls run())
+		std::vector< std::thread > m_threads;
+		std::mutex m_runMutex;
+		std::mutex m_mutex;
+		std::condition_variable m_taskSubmitted;
+		std::condition_variable m_taskFinished;
+		const Task* m_task;
+		size_t m_taskGeneration;
+		size_t m_busyWorkerCount;
+		bool m_isStopping;
+	};
+
+
+	/**
+	 * Holds back each of a fixed number of threads until all of them have
+	 * reached it. Waiting threads spin (then yield) rather than sleep, since
+	 * tasks run by a ThreadPool usually cross a barrier every few microseconds.
+	 */
+	class ThreadBarrier
+	{
+	public:
+		static const int SPINS_BEFORE_YIELDING = 1024;
+
+		ThreadBarrier( size_t threadCount );
+		~ThreadBarrier();
+
+		void wait();
+
+	protected:
+		size_t m_threadCount;
+		std::atomic< size_t > m_waitingThreadCount;
+		std::atomic< size_t > m_generation;
+	};
+}
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef ATC_THREADPOOL_INL
+#define ATC_THREADPOOL_INL
+
+namespace atc
+{
+	inline size_t ThreadPool::getThreadCount() const
+	{
+		return m_threadCount;
+	}
+
+
+	inline bool ThreadPool::isRunning() const
+	{
+		return !m_threads.empty();
+	}
+}
+
+#endif
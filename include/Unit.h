@@ -25,7 +25,9 @@ namespace atc
 		virtual ~Unit();
 
 		virtual void update( double elapsedTime );
+#ifndef ATC_HEADLESS
 		virtual void draw( Renderer* renderer );
+#endif
 		virtual void onCollision( Actor* other, const Vector& displacement, float collisionDistance );
 
 		void setTargetLocation( const Point& target );
@@ -32,8 +32,18 @@ namespace atc
 
 	inline bool Unit::canMoveDirectlyTo( const Point& destination )
 	{
-		// Trace from the Unit to the destination and return whether the trace is passable.
-		return getWorld()->traceIsPassable( m_position, destination, TRACE_RADIUS );
+		bool result = false;
+
+		if( hasFormation() && m_formation->hasFlowfield() )
+		{
+			// Skip the trace if the Formation's Flowfield already knows nothing is in the way.
+			const Flowfield* flowfield = m_formation->getFlowfield();
+			result = flowfield->hasLineOfSight( getWorld()->getFlowfieldTileAtPosition( flowfield, m_position ),
+												getWorld()->getFlowfieldTileAtPosition( flowfield, destination ), TRACE_RADIUS );
+		}
+
+		// Otherwise, trace from the Unit to the destination and return whether the trace is passable.
+		return ( result || getWorld()->traceIsPassable( m_position, destination, TRACE_RADIUS ) );
 	}
 
 
@@ -16,7 +16,9 @@ namespace atc
 		UnitSelection();
 		virtual ~UnitSelection();
 
+#ifndef ATC_HEADLESS
 		void draw( Renderer* renderer );
+#endif
 
 		void addUnit( Unit* unit );
 		void addUnits( const UnitSelection& selection );
@@ -26,6 +28,7 @@ namespace atc
 
 		virtual void orderMoveTo( const Point& location );
 
+		Point findReachableDestination( const Point& destination ) const;
 		Point calculateCenterOfMass() const;
 		float calculateMaximumMoveSpeed() const;
 
@@ -71,7 +71,7 @@ namespace atc
 
 	inline float Vector::getLength() const
 	{
-		return std::sqrtf( getLengthSquared() );
+		return sqrtf( getLengthSquared() );
 	}
 
 
@@ -90,7 +90,7 @@ namespace atc
 
 	inline Direction::Direction( float x, float y )
 	{
-		float length = std::sqrtf( ( x * x ) + ( y * y ) );
+		float length = sqrtf( ( x * x ) + ( y * y ) );
 		requires( length > 0.0f );
 
 		m_x = ( x / length );
@@ -58,6 +58,8 @@ namespace atc
 		Point screenToDeviceCoords( const Point& screenCoords ) const;
 
 		void toggleTrace();
+		void toggleCrowdDensity();
+		void toggleOctileFlowfields();
 
 	protected:
 		struct MouseButtonState
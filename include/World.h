@@ -11,6 +11,25 @@ namespace atc
 	public:
 		static const char* MAP_FOLDER_PATH;
 		static const char* MAP_FILE_EXTENSION;
+		static const char* FLOWFIELD_CACHE_FOLDER_PATH;
+
+		/**
+		 * Time spent (in seconds) in each phase of the most recent update.
+		 */
+		struct UpdateProfile
+		{
+			UpdateProfile();
+
+			double getTotalTime() const;
+
+			double mapTime;
+			double formationTime;
+			double actorTime;
+			double collisionTime;
+			double wallCollisionTime;
+			double crowdTime;
+			double cleanupTime;
+		};
 
 		World();
 		~World();
@@ -25,14 +44,19 @@ namespace atc
 		void removeAllActors();
 
 		void update( double elapsedTime );
+		const UpdateProfile& getLastUpdateProfile() const;
+		size_t getActorCount() const;
+
+#ifndef ATC_HEADLESS
 		void draw( Renderer* renderer );
 
 		Camera* spawnDefaultCamera();
-		Unit* spawnUnit( const Point& location );
-
 		void setCamera( Camera* camera );
 		Camera* getCamera() const;
 		Point getMouseWorldPosition() const;
+#endif
+
+		Unit* spawnUnit( const Point& location );
 		UnitSelection& getUnitSelection();
 		void setUnitSelection( const UnitSelection& selection );
 		const UnitSelection& getUnitSelection() const;
@@ -43,6 +67,7 @@ namespace atc
 
 		Map* getMap();
 		const Map* getMap() const;
+		const std::vector< Map::TileVector >& getMarkedGoals() const;
 		float getLeft() const;
 		float getRight() const;
 		float getBottom() const;
@@ -77,8 +102,17 @@ namespace atc
 		bool isTracing() const;
 
 	protected:
+#ifndef ATC_HEADLESS
 		void drawMap( Renderer* renderer, short tileLeft, short tileBottom, short tileRight, short tileTop );
-		void drawFlowfield( Flowfield* flowfield, Renderer* renderer, Color color, short tileLeft, short tileBottom, short tileRight, short tileTop );
+		void drawFlowfield( const Flowfield* flowfield, Renderer* renderer, Color color, short tileLeft, short tileBottom, short tileRight, short tileTop );
+#endif
+
+		void updateFormations( double elapsedTime );
+		void updateActors( double elapsedTime );
+		void collideActors();
+		void collideActorsWithWalls();
+		void recordCrowdPositions();
+		void splatCrowd( double elapsedTime );
 
 		void destroyRemovedActors();
 		void destroyEmptyFormations();
@@ -89,11 +123,19 @@ namespace atc
 		bool m_isTracing;
 		Point m_traceOrigin;
 		Point m_traceDestination;
+		UpdateProfile m_lastUpdateProfile;
 		std::map< Actor::ID, Actor* > m_actorsByID;
 		std::vector< Actor* > m_actorsToRemove;
+		std::vector< Actor* > m_collidableActors;
+		std::vector< Point > m_collidableStartPositions; // (Where m_actorHash bucketed each collidable Actor)
+		std::vector< Actor* > m_nearbyActors;
+		std::vector< Actor* > m_crowdActors;
+		std::vector< Point > m_crowdStartPositions;
+		SpatialHash m_actorHash;
 		std::map< int, Formation* > m_formationsByIndex;
 		UnitSelection m_unitSelection;
 		Map m_map;
+		std::vector< Map::TileVector > m_markedGoals; // Where the map designer expects Formations to be sent.
 	};
 }
 
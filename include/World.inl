@@ -1,5 +1,26 @@
 namespace atc
 {
+	// ------------------------------ UpdateProfile ------------------------------
+
+	inline World::UpdateProfile::UpdateProfile() :
+		mapTime( 0.0 ),
+		formationTime( 0.0 ),
+		actorTime( 0.0 ),
+		collisionTime( 0.0 ),
+		wallCollisionTime( 0.0 ),
+		crowdTime( 0.0 ),
+		cleanupTime( 0.0 )
+	{ }
+
+
+	inline double World::UpdateProfile::getTotalTime() const
+	{
+		return ( mapTime + formationTime + actorTime + collisionTime + wallCollisionTime + crowdTime + cleanupTime );
+	}
+
+
+	// ------------------------------ World ------------------------------
+
 	inline Actor* World::getActorByID( Actor::ID id ) const
 	{
 		Actor* result = nullptr;
@@ -14,6 +35,19 @@ namespace atc
 	}
 
 
+	inline const World::UpdateProfile& World::getLastUpdateProfile() const
+	{
+		return m_lastUpdateProfile;
+	}
+
+
+	inline size_t World::getActorCount() const
+	{
+		return m_actorsByID.size();
+	}
+
+
+#ifndef ATC_HEADLESS
 	inline void World::setCamera( Camera* camera )
 	{
 		// Make sure the camera is valid and already in the World.
@@ -29,6 +63,7 @@ namespace atc
 	{
 		return m_camera;
 	}
+#endif
 
 
 	inline UnitSelection& World::getUnitSelection()
@@ -61,6 +96,12 @@ namespace atc
 	}
 
 
+	inline const std::vector< Map::TileVector >& World::getMarkedGoals() const
+	{
+		return m_markedGoals;
+	}
+
+
 	inline float World::getLeft() const
 	{
 		return m_map.getLeft();
@@ -198,6 +239,22 @@ namespace atc
 		case CARDINAL_DIRECTION_WEST:
 			result = Direction( Angle::WEST );
 			break;
+
+		case CARDINAL_DIRECTION_NORTHEAST:
+			result = Direction( Angle::NORTHEAST );
+			break;
+
+		case CARDINAL_DIRECTION_NORTHWEST:
+			result = Direction( Angle::NORTHWEST );
+			break;
+
+		case CARDINAL_DIRECTION_SOUTHWEST:
+			result = Direction( Angle::SOUTHWEST );
+			break;
+
+		case CARDINAL_DIRECTION_SOUTHEAST:
+			result = Direction( Angle::SOUTHEAST );
+			break;
 		}
 
 		return result;
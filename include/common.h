@@ -1,9 +1,13 @@
 // Library includes.
+#ifndef ATC_HEADLESS
+
 #define GLEW_STATIC
 #include "GL/glew.h"
 
 #include "GLFW/glfw3.h"
 
+#endif
+
 #define STBI_HEADER_FILE_ONLY
 #include "stb_image.c"
 
@@ -12,8 +16,25 @@
 #include <iostream>
 #include <vector>
 #include <map>
+#include <set>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include <chrono>
+#include <deque>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
 
 #include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
 
 
 #ifdef WIN32
@@ -67,6 +88,8 @@ namespace atc
 
 
 // Header Includes:
+#ifndef ATC_HEADLESS
+
 #include "App.h"
 
 namespace atc
@@ -78,9 +101,19 @@ namespace atc
 #include "Font.h"
 #include "Renderer.h"
 #include "Window.h"
+
+#endif
+
 #include "Actor.h"
+#include "SpatialHash.h"
+
+#ifndef ATC_HEADLESS
+
 #include "Camera.h"
 #include "HUD.h"
+
+#endif
+
 #include "Orderable.h"
 #include "UnitSelection.h"
 #include "FormationBehavior.h"
@@ -88,30 +121,53 @@ namespace atc
 #include "Path.h"
 #include "Grid.h"
 #include "MinHeap.h"
+#include "BucketQueue.h"
+#include "ThreadPool.h"
 #include "Flowfield.h"
+#include "FlowfieldWorker.h"
 #include "Map.h"
+#include "SectorGraph.h"
+#include "CrowdDensity.h"
 #include "World.h"
 #include "Unit.h"
 
 // Inline Includes:
-#include "App.inl"
 #include "Color.inl"
 #include "Angle.inl"
 #include "Vector.inl"
+
+#ifndef ATC_HEADLESS
+
+#include "App.inl"
 #include "Texture.inl"
 #include "Font.inl"
 #include "Renderer.inl"
 #include "Window.inl"
+
+#endif
+
 #include "Actor.inl"
+#include "SpatialHash.inl"
+
+#ifndef ATC_HEADLESS
+
 #include "Camera.inl"
 #include "HUD.inl"
+
+#endif
+
 #include "UnitSelection.inl"
 #include "Formation.inl"
 #include "FormationBehavior.inl"
 #include "Path.inl"
 #include "Grid.inl"
 #include "MinHeap.inl"
+#include "BucketQueue.inl"
+#include "ThreadPool.inl"
 #include "Flowfield.inl"
+#include "FlowfieldWorker.inl"
 #include "Map.inl"
+#include "SectorGraph.inl"
+#include "CrowdDensity.inl"
 #include "World.inl"
 #include "Unit.inl"
\ No newline at end of file
@@ -17,6 +17,10 @@ namespace atc
 	const Angle Angle::NORTH( PI_OVER_2 );
 	const Angle Angle::WEST( PI );
 	const Angle Angle::SOUTH( PI + PI_OVER_2 );
+	const Angle Angle::NORTHEAST( PI_OVER_4 );
+	const Angle Angle::NORTHWEST( PI_OVER_2 + PI_OVER_4 );
+	const Angle Angle::SOUTHWEST( PI + PI_OVER_4 );
+	const Angle Angle::SOUTHEAST( PI + PI_OVER_2 + PI_OVER_4 );
 
 	const Rotation Rotation::NO_REVOLUTION( 0.0f );
 	const Rotation Rotation::QUARTER_REVOLUTION( Angle::PI_OVER_2 );
@@ -39,6 +39,7 @@ namespace atc
 		// Set up the World and load a default map.
 		m_world = new World();
 		m_world->loadMap( "04" );
+		m_world->getMap()->setFlowfieldCacheFolder( World::FLOWFIELD_CACHE_FOLDER_PATH );
 		m_world->init();
 
 		// Set up the HUD.
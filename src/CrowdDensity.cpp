@@ -0,0 +1,230 @@
+#include "common.h"
+#include "CrowdDensity.h"
+
+
+namespace atc
+{
+	const int CrowdDensity::CELL_SIZE;
+	const size_t CrowdDensity::MIN_UNITS_PER_THREAD;
+	const unsigned int CrowdDensity::MAX_CONGESTION_COST;
+	const float CrowdDensity::SMOOTHING_TIME = 0.5f;
+	const float CrowdDensity::CONGESTED_DENSITY = 0.25f;
+	const float CrowdDensity::DENSITY_PER_COST = 0.125f;
+
+
+	CrowdDensity::CrowdDensity( const Map* map ) :
+		m_map( map ),
+		m_cellsWide( 0 ),
+		m_cellsHigh( 0 ),
+		m_arePassableTileCountsValid( false )
+	{ }
+
+
+	CrowdDensity::~CrowdDensity() { }
+
+
+	void CrowdDensity::clear()
+	{
+		// Forget the crowds on the old tiles. The grid is sized to the Map again on the next update.
+		m_cellsWide = 0;
+		m_cellsHigh = 0;
+		m_arePassableTileCountsValid = false;
+		m_passableTileCounts.clear();
+		m_congestions.clear();
+		m_congestionCosts.clear();
+		m_splatsByThread.clear();
+		clearUnits();
+	}
+
+
+	void CrowdDensity::invalidatePassableTileCounts()
+	{
+		m_arePassableTileCountsValid = false;
+	}
+
+
+	void CrowdDensity::clearUnits()
+	{
+		m_unitXs.clear();
+		m_unitYs.clear();
+		m_unitVelocityXs.clear();
+		m_unitVelocityYs.clear();
+	}
+
+
+	void CrowdDensity::addUnit( const Point& position, const Vector& velocity )
+	{
+		m_unitXs.push_back( position.x );
+		m_unitYs.push_back( position.y );
+		m_unitVelocityXs.push_back( velocity.x );
+		m_unitVelocityYs.push_back( velocity.y );
+	}
+
+
+	void CrowdDensity::update( double elapsedTime )
+	{
+		if( m_cellsWide != ( ( m_map->getWidth() + CELL_SIZE - 1 ) / CELL_SIZE ) ||
+			m_cellsHigh != ( ( m_map->getHeight() + CELL_SIZE - 1 ) / CELL_SIZE ) )
+		{
+			resize();
+		}
+
+		if( !m_arePassableTileCountsValid )
+		{
+			countPassableTiles();
+		}
+
+		// Only wake as many threads as there are Units to keep busy.
+		size_t unitCount = m_unitXs.size();
+		size_t threadCount = std::max< size_t >( std::min( m_threadPool.getThreadCount(), unitCount / MIN_UNITS_PER_THREAD ), 1 );
+		float smoothing = std::min( (float) elapsedTime / SMOOTHING_TIME, 1.0f );
+
+		m_unitCells.resize( unitCount );
+
+		if( m_splatsByThread.size() < threadCount )
+		{
+			m_splatsByThread.resize( threadCount );
+		}
+
+		if( threadCount > 1 )
+		{
+			ThreadBarrier barrier( threadCount );
+
+			m_threadPool.run( [ this, threadCount, smoothing, &barrier ]( size_t threadIndex )
+			{
+				if( threadIndex < threadCount )
+				{
+					// Each thread splats its share of the Units into a grid of its own, then adds up its share of the cells.
+					splatUnits( threadIndex, threadCount );
+					barrier.wait();
+					gatherCells( threadIndex, threadCount, smoothing );
+				}
+			} );
+		}
+		else
+		{
+			splatUnits( 0, 1 );
+			gatherCells( 0, 1, smoothing );
+		}
+	}
+
+
+	void CrowdDensity::resize()
+	{
+		m_cellsWide = ( ( m_map->getWidth() + CELL_SIZE - 1 ) / CELL_SIZE );
+		m_cellsHigh = ( ( m_map->getHeight() + CELL_SIZE - 1 ) / CELL_SIZE );
+		m_arePassableTileCountsValid = false;
+		m_congestions.assign( getCellCount(), 0.0f );
+		m_congestionCosts.assign( getCellCount(), 0 );
+		m_splatsByThread.clear();
+	}
+
+
+	void CrowdDensity::countPassableTiles()
+	{
+		m_passableTileCounts.assign( getCellCount(), 0 );
+
+		for( Map::TileOffset y = 0; y < (Map::TileOffset) m_map->getHeight(); ++y )
+		{
+			for( Map::TileOffset x = 0; x < (Map::TileOffset) m_map->getWidth(); ++x )
+			{
+				// A cell that is mostly wall fills up with fewer Units.
+				if( m_map->getTile( x, y )->isPassable() )
+				{
+					++m_passableTileCounts[ getCellIndex( TileVector( x, y ) ) ];
+				}
+			}
+		}
+
+		m_arePassableTileCountsValid = true;
+	}
+
+
+	void CrowdDensity::splatUnits( size_t threadIndex, size_t threadCount )
+	{
+		requires( threadIndex < threadCount );
+
+		size_t unitCount = m_unitXs.size();
+		size_t first = ( ( unitCount * threadIndex ) / threadCount );
+		size_t last = ( ( unitCount * ( threadIndex + 1 ) ) / threadCount );
+
+		const float* xs = m_unitXs.data();
+		const float* ys = m_unitYs.data();
+		const float* velocityXs = m_unitVelocityXs.data();
+		const float* velocityYs = m_unitVelocityYs.data();
+		unsigned int* cells = m_unitCells.data();
+
+		// Find the cell of every Unit first. Tiles are centered on whole coordinates, and Actors
+		// are kept within the Map, so this is a plain multiply and clamp for each Unit.
+		const float inverseCellSize = ( 1.0f / CELL_SIZE );
+		const int lastCellX = ( (int) m_cellsWide - 1 );
+		const int lastCellY = ( (int) m_cellsHigh - 1 );
+		const int cellsWide = (int) m_cellsWide;
+
+		for( size_t i = first; i < last; ++i )
+		{
+			int cellX = std::min( std::max( (int) ( ( xs[ i ] + 0.5f ) * inverseCellSize ), 0 ), lastCellX );
+			int cellY = std::min( std::max( (int) ( ( ys[ i ] + 0.5f ) * inverseCellSize ), 0 ), lastCellY );
+			cells[ i ] = (unsigned int) ( cellX + ( cellY * cellsWide ) );
+		}
+
+		// Then add each Unit to its cell.
+		std::vector< CellSplat >& splats = m_splatsByThread[ threadIndex ];
+		splats.assign( getCellCount(), CellSplat() );
+
+		for( size_t i = first; i < last; ++i )
+		{
+			CellSplat& splat = splats[ cells[ i ] ];
+			splat.unitCount += 1.0f;
+			splat.velocityX += velocityXs[ i ];
+			splat.velocityY += velocityYs[ i ];
+		}
+	}
+
+
+	void CrowdDensity::gatherCells( size_t threadIndex, size_t threadCount, float smoothing )
+	{
+		requires( threadIndex < threadCount );
+
+		size_t cellCount = getCellCount();
+		size_t first = ( ( cellCount * threadIndex ) / threadCount );
+		size_t last = ( ( cellCount * ( threadIndex + 1 ) ) / threadCount );
+
+		for( size_t cell = first; cell < last; ++cell )
+		{
+			// Add up what every thread splatted into the cell.
+			CellSplat total;
+
+			for( size_t i = 0; i < threadCount; ++i )
+			{
+				const CellSplat& splat = m_splatsByThread[ i ][ cell ];
+				total.unitCount += splat.unitCount;
+				total.velocityX += splat.velocityX;
+				total.velocityY += splat.velocityY;
+			}
+
+			float congestion = 0.0f;
+
+			if( total.unitCount > 0.0f && m_passableTileCounts[ cell ] > 0 )
+			{
+				// Units flowing the same way at full speed aren't in each other's way, however close together they are. Units
+				// that are stuck (or pushing past each other in opposite directions) have an average velocity near zero.
+				float flowSpeed = ( sqrtf( ( total.velocityX * total.velocityX ) + ( total.velocityY * total.velocityY ) ) / total.unitCount );
+				float density = ( total.unitCount / m_passableTileCounts[ cell ] );
+				congestion = ( density * std::max( 1.0f - ( flowSpeed / Unit::MOVEMENT_SPEED ), 0.0f ) );
+			}
+
+			// Smooth the congestion over several ticks, so it doesn't jump as Units cross between cells.
+			m_congestions[ cell ] += ( ( congestion - m_congestions[ cell ] ) * smoothing );
+
+			// Only change the cost once the congestion is a whole step away from it, so it doesn't flicker
+			// between two costs (and make the Map repair its flowfields over and over).
+			float level = std::max( ( ( m_congestions[ cell ] - CONGESTED_DENSITY ) / DENSITY_PER_COST ) + 1.0f, 0.0f );
+
+			if( fabsf( level - m_congestionCosts[ cell ] ) >= 1.0f )
+			{
+				m_congestionCosts[ cell ] = std::min( (unsigned int) level, MAX_CONGESTION_COST );
+			}
+		}
+	}
+}
@@ -3,73 +3,1794 @@
 
 namespace atc
 {
+	const size_t Flowfield::CLEAR_REACHED_DIVISOR;
+	const int Flowfield::FIELD_VECTOR_SCALE;
+	const int Flowfield::MIN_BLENDED_FIELD_VECTOR_LENGTH;
+	const unsigned int Flowfield::OCTILE_STRAIGHT_STEP_COST;
+	const unsigned int Flowfield::OCTILE_DIAGONAL_STEP_COST;
+	const uint32_t Flowfield::FILE_MAGIC;
+	const uint32_t Flowfield::FILE_VERSION;
+
+
 	Flowfield::Flowfield() :
+		m_isShared( false ),
+		m_referenceCount( 0 ),
+		m_status( STATUS_EMPTY ),
 		m_map( nullptr ),
-		m_isReserved( false ),
-		m_goalTile( getTile( 0, 0 ) )
+		m_goalTile( getTile( 0, 0 ) ),
+		m_integrationMethod( INTEGRATION_METHOD_AUTOMATIC ),
+		m_activeIntegrationMethod( INTEGRATION_METHOD_QUEUE ),
+		m_canClearReachedTiles( false ),
+		m_tileQueueHead( 0 ),
+		m_tileQueueTail( 0 ),
+		m_isOctile( false ),
+		m_lineOfSightRadius( -1.0f ),
+		m_isVectorFieldEnabled( false ),
+		m_repairStamp( 0 ),
+		m_isCompressed( false ),
+		m_isHierarchical( false ),
+		m_sectorGraph( nullptr ),
+		m_loadedSectorCount( 0 )
 	{ }
 
 
-	Flowfield::~Flowfield() { }
+	Flowfield::~Flowfield() { }
+
+
+	void Flowfield::recalculate()
+	{
+		// Build the whole Flowfield at once.
+		beginRecalculation();
+		continueRecalculation( std::numeric_limits< size_t >::max() );
+	}
+
+
+	void Flowfield::beginRecalculation()
+	{
+		setStatus( STATUS_BUILDING );
+
+		// Clear any existing data. Only the flow plane needs clearing, since distances are only read from closed tiles.
+		allocatePlanes();
+		clearFlows();
+		m_canClearReachedTiles = !m_isHierarchical;
+		m_statistics = Statistics();
+
+		// Add goal location.
+		m_goalTiles.clear();
+		m_goalTiles.push_back( m_goalTile );
+		m_goalTile->setGoal( true );
+
+		if( !m_isHierarchical )
+		{
+			// Add the rest of the goal region. (Hierarchical flowfields only search from the goal tile,
+			// since the SectorGraph finds the distances within the goal sector from a single tile.)
+			for( const TileVector& position : m_goalRegion )
+			{
+				Tile tile = getTile( position );
+
+				if( !tile->isGoal() )
+				{
+					tile->setGoal( true );
+					m_goalTiles.push_back( tile );
+				}
+			}
+		}
+
+		for( Tile& tile : m_goalTiles )
+		{
+			tile->setClosed( true );
+			setDistanceToGoal( tile, 0 );
+		}
+
+		// Lines of sight only depend on the Map, so find them first. They can be read while the rest is built.
+		// (Clearing the flow plane already forgot the old ones.)
+		m_lineOfSightMin = TileVector( (TileOffset) m_width, (TileOffset) m_height );
+		m_lineOfSightMax = TileVector( -1, -1 );
+		findLinesOfSight();
+
+		if( m_isHierarchical )
+		{
+			// Only search between portals for now. Sectors are integrated as they are loaded.
+			// Bringing the SectorGraph up to date here keeps its rebuild on whichever thread builds the Flowfield.
+			m_sectorGraph = m_map->getSectorGraph();
+			integrateSectorGraph();
+		}
+		else
+		{
+			// Start the open set with the goals. It is kept between calls to continueRecalculation().
+			m_activeIntegrationMethod = chooseIntegrationMethod();
+
+			if( m_activeIntegrationMethod == INTEGRATION_METHOD_HEAP )
+			{
+				m_tilesToEvaluate.clear();
+			}
+			else if( m_activeIntegrationMethod == INTEGRATION_METHOD_BUCKETS && m_isOctile )
+			{
+				// No step costs more than a diagonal step onto a tile of the maximum cost.
+				m_octileBuckets.clear();
+				m_octileBuckets.setMaxKeySpread( MapTile::MAX_COST * OCTILE_DIAGONAL_STEP_COST );
+			}
+			else if( m_activeIntegrationMethod == INTEGRATION_METHOD_BUCKETS )
+			{
+				// No tile offers more than the maximum tile cost beyond the one being expanded.
+				m_tileBuckets.clear();
+				m_tileBuckets.setMaxKeySpread( MapTile::MAX_COST );
+			}
+			else
+			{
+				// Each tile is queued at most once, so the queue never needs to wrap around.
+				m_tileQueue.resize( m_width * m_height );
+				m_tileQueueHead = 0;
+				m_tileQueueTail = 0;
+
+				if( m_activeIntegrationMethod == INTEGRATION_METHOD_PARALLEL )
+				{
+					m_queueOrders.resize( m_width * m_height );
+				}
+			}
+
+			for( const Tile& tile : m_goalTiles )
+			{
+				// The heap and buckets key each tile by the distance it offers its neighbors (its own distance plus its
+				// cost), so tiles are closed as soon as they are reached, just as with the queue.
+				TileVector position = tile.getPosition();
+				unsigned int goalKey = getTileCost( position );
+
+				if( m_activeIntegrationMethod == INTEGRATION_METHOD_HEAP )
+				{
+					m_tilesToEvaluate.insert( goalKey, tile );
+				}
+				else if( m_activeIntegrationMethod == INTEGRATION_METHOD_BUCKETS && m_isOctile )
+				{
+					// Octile flowfields step from each goal both straight and diagonally.
+					m_octileBuckets.insert( getStepCost( position, CARDINAL_DIRECTION_EAST ), OctileStep( tile, false ) );
+					m_octileBuckets.insert( getStepCost( position, CARDINAL_DIRECTION_NORTHEAST ), OctileStep( tile, true ) );
+					++m_statistics.queueOperations;
+				}
+				else if( m_activeIntegrationMethod == INTEGRATION_METHOD_BUCKETS )
+				{
+					m_tileBuckets.insert( goalKey, tile );
+				}
+				else
+				{
+					if( m_activeIntegrationMethod == INTEGRATION_METHOD_PARALLEL )
+					{
+						m_queueOrders[ getTileIndex( position ) ] = (unsigned int) m_tileQueueTail;
+					}
+
+					m_tileQueue[ m_tileQueueTail++ ] = position;
+				}
+
+				++m_statistics.queueOperations;
+			}
+		}
+	}
+
+
+	bool Flowfield::continueRecalculation( size_t maxTileCount )
+	{
+		requires( getStatus() == STATUS_BUILDING || getStatus() == STATUS_PARTIAL );
+		bool isFinished = true;
+
+		if( !m_isHierarchical )
+		{
+			// Expand up to the given number of tiles. Hierarchical flowfields were finished when they began.
+			if( m_activeIntegrationMethod == INTEGRATION_METHOD_QUEUE )
+			{
+				isFinished = integrateWithQueue( maxTileCount );
+			}
+			else if( m_activeIntegrationMethod == INTEGRATION_METHOD_PARALLEL )
+			{
+				isFinished = integrateInParallel( maxTileCount );
+			}
+			else if( m_activeIntegrationMethod == INTEGRATION_METHOD_BUCKETS )
+			{
+				isFinished = ( m_isOctile ? integrateOctile( maxTileCount ) : integrateWithBuckets( maxTileCount ) );
+			}
+			else
+			{
+				isFinished = integrateWithHeap( maxTileCount );
+			}
+		}
+
+		if( isFinished && m_statistics.tilesExpanded > ( m_width * m_height ) / CLEAR_REACHED_DIVISOR )
+		{
+			// Finding so many tiles again would take longer than clearing them all.
+			m_canClearReachedTiles = false;
+		}
+
+		if( isFinished && m_isVectorFieldEnabled && !m_isHierarchical )
+		{
+			// Smooth the distances into the vector field before publishing it.
+			findFieldVectors();
+		}
+
+		// Publish the finished Flowfield, or let the tiles reached so far be read.
+		setStatus( isFinished ? STATUS_READY : STATUS_PARTIAL );
+		return isFinished;
+	}
+
+
+	void Flowfield::recalculateAsync()
+	{
+		// Let the Map rebuild this Flowfield in the background.
+		m_map->submitFlowfield( this );
+	}
+
+
+	void Flowfield::repair( const std::vector< TileVector >& changedPositions )
+	{
+		// Hierarchical flowfields depend on the SectorGraph, so they have to be recalculated instead.
+		requires( isReady() && !m_isHierarchical && !m_isCompressed );
+
+		m_statistics = Statistics();
+		m_tilesToEvaluate.clear();
+		m_repairedTiles.clear();
+
+		if( m_repairStamps.size() != ( m_width * m_height ) )
+		{
+			m_repairStamps.assign( m_width * m_height, 0 );
+			m_repairStamp = 0;
+		}
+
+		// Start a new stamp, so no tile is marked as invalidated yet.
+		++m_repairStamp;
+
+		if( m_repairStamp == 0 )
+		{
+			std::fill( m_repairStamps.begin(), m_repairStamps.end(), 0 );
+			m_repairStamp = 1;
+		}
+
+		for( const TileVector& position : changedPositions )
+		{
+			Tile tile = getTile( position );
+
+			if( tile->isGoal() )
+			{
+				// The goal is always where the search starts from, passable or not, but its
+				// neighbors may need to add or remove it from their adjacencies.
+				m_repairedTiles.push_back( tile );
+			}
+			else if( !isInvalidated( tile ) )
+			{
+				// Every changed tile has to be integrated again.
+				invalidateTile( tile );
+			}
+
+			CardinalDirection direction = CARDINAL_DIRECTION_EAST;
+
+			for( size_t i = 0; i < getDirectionCount(); ++i )
+			{
+				// If the cost of the tile changed, so did the distance of every neighbor reached through it. (On
+				// octile flowfields, its straight neighbors may also no longer be able to step diagonally past it.)
+				Tile adjacentTile = tile.getAdjacentTile( direction );
+
+				if( adjacentTile.isValid() && adjacentTile->isClosed() && !adjacentTile->isGoal() )
+				{
+					m_tilesToEvaluate.insert( getDistanceToGoal( adjacentTile ), adjacentTile );
+					++m_statistics.queueOperations;
+				}
+
+				direction = getNextDirection( direction );
+			}
+		}
+
+		while( !m_tilesToEvaluate.isEmpty() )
+		{
+			// Visit the tiles that may have been reached through an invalidated tile, closest first.
+			Tile tile = m_tilesToEvaluate.popMinElement();
+			++m_statistics.queueOperations;
+
+			if( isInvalidated( tile ) )
+			{
+				continue;
+			}
+
+			// Keep the distance if the tile is still reached through a tile that wasn't invalidated.
+			// Tiles closer to the goal were all visited first, so they won't be invalidated later.
+			bool hasValidParent = false;
+			CardinalDirection direction = CARDINAL_DIRECTION_EAST;
+
+			for( size_t i = 0; i < getDirectionCount() && !hasValidParent; ++i )
+			{
+				Tile adjacentTile = tile.getAdjacentTile( direction );
+
+				hasValidParent = ( adjacentTile.isValid() && adjacentTile->isClosed() && !isInvalidated( adjacentTile ) &&
+								   ( getDistanceToGoal( adjacentTile ) + getStepCost( adjacentTile.getPosition(), direction ) ) == getDistanceToGoal( tile ) &&
+								   !cutsCorner( tile.getPosition(), direction ) );
+
+				direction = getNextDirection( direction );
+			}
+
+			if( !hasValidParent )
+			{
+				invalidateTile( tile );
+			}
+
+			if( m_repairedTiles.size() > ( m_width * m_height ) / REPAIR_FALLBACK_DIVISOR )
+			{
+				// So much of the Flowfield has been invalidated that it's faster to start over.
+				m_tilesToEvaluate.clear();
+				recalculate();
+				return;
+			}
+		}
+
+		for( Tile& tile : m_repairedTiles )
+		{
+			if( !tile->isGoal() )
+			{
+				// Forget the old distances of the invalidated tiles.
+				tile->setClosed( false );
+			}
+		}
+
+		const Map* map = m_map;
+		size_t invalidatedTileCount = m_repairedTiles.size();
+
+		for( size_t i = 0; i < invalidatedTileCount; ++i )
+		{
+			Tile tile = m_repairedTiles[ i ];
+			TileVector position = tile.getPosition();
+
+			if( tile->isGoal() || !map->getTile( position.x, position.y )->isPassable() )
+			{
+				continue;
+			}
+
+			// Start from the best distance through the tiles around the invalidated region.
+			CardinalDirection direction = CARDINAL_DIRECTION_EAST;
+
+			for( size_t j = 0; j < getDirectionCount(); ++j )
+			{
+				Tile adjacentTile = tile.getAdjacentTile( direction );
+
+				if( adjacentTile.isValid() && adjacentTile->isClosed() && !cutsCorner( position, direction ) )
+				{
+					unsigned int distance = ( getDistanceToGoal( adjacentTile ) + getStepCost( adjacentTile.getPosition(), direction ) );
+
+					if( !tile->isClosed() || distance < getDistanceToGoal( tile ) )
+					{
+						setDistanceToGoal( tile, distance );
+						tile->setClosed( true );
+					}
+				}
+
+				direction = getNextDirection( direction );
+			}
+
+			if( tile->isClosed() )
+			{
+				m_tilesToEvaluate.insert( getDistanceToGoal( tile ), tile );
+				++m_statistics.queueOperations;
+			}
+		}
+
+		if( m_isOctile )
+		{
+			for( const TileVector& position : changedPositions )
+			{
+				// A tile that became passable lets its straight neighbors step diagonally past it,
+				// which may be a shorter route for them even though none of them were invalidated.
+				Tile tile = getTile( position );
+				CardinalDirection direction = CARDINAL_DIRECTION_EAST;
+
+				for( size_t i = 0; i < CARDINAL_DIRECTION_COUNT; ++i )
+				{
+					Tile adjacentTile = tile.getAdjacentTile( direction );
+
+					if( adjacentTile.isValid() && adjacentTile->isClosed() )
+					{
+						m_tilesToEvaluate.insert( getDistanceToGoal( adjacentTile ), adjacentTile );
+						++m_statistics.queueOperations;
+					}
+
+					direction = getCounterClockwiseDirection( direction );
+				}
+			}
+		}
+
+		while( !m_tilesToEvaluate.isEmpty() )
+		{
+			// Pop the closest tile, skipping any that were since reached by a shorter route.
+			unsigned int distance = m_tilesToEvaluate.peekMinKey();
+			Tile tile = m_tilesToEvaluate.popMinElement();
+			++m_statistics.queueOperations;
+
+			if( distance > getDistanceToGoal( tile ) )
+			{
+				continue;
+			}
+
+			++m_statistics.tilesExpanded;
+			CardinalDirection direction = CARDINAL_DIRECTION_EAST;
+
+			for( size_t i = 0; i < getDirectionCount(); ++i )
+			{
+				// Lower the distance of each passable neighbor that this tile is now a shorter route for.
+				// This also reaches tiles that only just became reachable (e.g. when a wall is removed).
+				Tile adjacentTile = tile.getAdjacentTile( direction );
+				unsigned int adjacentDistance = ( distance + getStepCost( tile.getPosition(), direction ) );
+
+				if( adjacentTile.isValid() && !adjacentTile->isGoal() &&
+					( !adjacentTile->isClosed() || adjacentDistance < getDistanceToGoal( adjacentTile ) ) )
+				{
+					TileVector position = adjacentTile.getPosition();
+
+					if( map->getTile( position.x, position.y )->isPassable() && !cutsCorner( tile.getPosition(), direction ) )
+					{
+						setDistanceToGoal( adjacentTile, adjacentDistance );
+						adjacentTile->setClosed( true );
+						m_tilesToEvaluate.insert( adjacentDistance, adjacentTile );
+						++m_statistics.queueOperations;
+
+						if( !isInvalidated( adjacentTile ) )
+						{
+							// Remember to update the adjacencies around this tile.
+							m_repairStamps[ getTileIndex( position ) ] = m_repairStamp;
+							m_repairedTiles.push_back( adjacentTile );
+						}
+					}
+				}
+
+				direction = getNextDirection( direction );
+			}
+		}
+
+		for( Tile& tile : m_repairedTiles )
+		{
+			// Find the best adjacency again for every tile whose distance (or the distance of a neighbor) changed.
+			updateBestAdjacency( tile );
+
+			CardinalDirection direction = CARDINAL_DIRECTION_EAST;
+
+			for( size_t i = 0; i < getDirectionCount(); ++i )
+			{
+				Tile adjacentTile = tile.getAdjacentTile( direction );
+
+				if( adjacentTile.isValid() )
+				{
+					updateBestAdjacency( adjacentTile );
+				}
+
+				direction = getNextDirection( direction );
+			}
+		}
+
+		if( !m_fieldVectors.empty() )
+		{
+			for( Tile& tile : m_repairedTiles )
+			{
+				// The vector of a tile depends on the distances of its straight neighbors.
+				updateFieldVector( tile.getPosition() );
+
+				for( CardinalDirection direction : { CARDINAL_DIRECTION_EAST, CARDINAL_DIRECTION_NORTH, CARDINAL_DIRECTION_WEST, CARDINAL_DIRECTION_SOUTH } )
+				{
+					Tile adjacentTile = tile.getAdjacentTile( direction );
+
+					if( adjacentTile.isValid() )
+					{
+						updateFieldVector( adjacentTile.getPosition() );
+					}
+				}
+			}
+		}
+
+		// Walls may have been put up in view of the goal, or taken down.
+		findLinesOfSight();
+	}
+
+
+	bool Flowfield::loadFromFile( const std::string& path )
+	{
+		// Only complete flowfields are saved, and only one that has never been built is loaded into, so a
+		// file that turns out not to match leaves nothing behind that could be read.
+		requires( getStatus() == STATUS_EMPTY && !m_isHierarchical );
+		static_assert( sizeof( FlowData ) == sizeof( uint8_t ) && sizeof( unsigned int ) == sizeof( uint32_t ), "Flowfield planes must match the file layout." );
+
+		bool result = false;
+		size_t tileCount = ( m_width * m_height );
+		FILE* file = fopen( path.c_str(), "rb" );
+
+		if( file )
+		{
+			FileHeader header;
+			TileVector goal = m_goalTile.getPosition();
+
+			// Only load a Flowfield built toward the same goals, the same way, over the same tiles.
+			result = ( fread( &header, sizeof( header ), 1, file ) == 1 && header.magic == FILE_MAGIC && header.version == FILE_VERSION &&
+					   header.mapHash == m_map->getContentHash() && header.width == m_width && header.height == m_height &&
+					   header.goalX == goal.x && header.goalY == goal.y && header.goalRegionSize == m_goalRegion.size() &&
+					   ( ( header.flags & FILE_FLAG_OCTILE ) != 0 ) == m_isOctile && tileCount > 0 );
+
+			if( result && !m_goalRegion.empty() )
+			{
+				std::vector< TileVector > goalRegion( m_goalRegion.size() );
+				result = ( fread( goalRegion.data(), sizeof( TileVector ), goalRegion.size(), file ) == goalRegion.size() &&
+						   std::equal( goalRegion.begin(), goalRegion.end(), m_goalRegion.begin() ) );
+			}
+
+			if( result )
+			{
+				// Read both planes straight into place. (The tiles that were read can't be told apart to clear them later)
+				allocatePlanes();
+				m_canClearReachedTiles = false;
+				result = ( fread( m_distancesToGoal.data(), sizeof( uint32_t ), tileCount, file ) == tileCount &&
+						   fread( &getTileData( 0 ), sizeof( uint8_t ), tileCount, file ) == tileCount );
+			}
+
+			fclose( file );
+		}
+
+		if( result )
+		{
+			// Lines of sight weren't saved, since they depend on the radius set here.
+			m_statistics = Statistics();
+			m_lineOfSightMin = TileVector( (TileOffset) m_width, (TileOffset) m_height );
+			m_lineOfSightMax = TileVector( -1, -1 );
+			findLinesOfSight();
+
+			if( m_isVectorFieldEnabled )
+			{
+				findFieldVectors();
+			}
+
+			setStatus( STATUS_READY );
+		}
+
+		return result;
+	}
+
+
+	bool Flowfield::saveToFile( const std::string& path ) const
+	{
+		requires( isReady() && !m_isHierarchical && !m_isCompressed );
+
+		bool result = false;
+		size_t tileCount = ( m_width * m_height );
+		FILE* file = fopen( path.c_str(), "wb" );
+
+		if( file )
+		{
+			TileVector goal = m_goalTile.getPosition();
+
+			FileHeader header;
+			header.magic = FILE_MAGIC;
+			header.version = FILE_VERSION;
+			header.mapHash = m_map->getContentHash();
+			header.width = (uint32_t) m_width;
+			header.height = (uint32_t) m_height;
+			header.goalX = goal.x;
+			header.goalY = goal.y;
+			header.goalRegionSize = (uint32_t) m_goalRegion.size();
+			header.flags = ( m_isOctile ? FILE_FLAG_OCTILE : FILE_FLAG_NONE );
+
+			std::vector< FlowData > flowPlane( tileCount );
+
+			for( size_t i = 0; i < tileCount; ++i )
+			{
+				// Leave out the lines of sight, which are found again for whoever loads the Flowfield.
+				flowPlane[ i ] = getTileData( i );
+				flowPlane[ i ].setLineOfSight( false );
+			}
+
+			result = ( fwrite( &header, sizeof( header ), 1, file ) == 1 &&
+					   fwrite( m_goalRegion.data(), sizeof( TileVector ), m_goalRegion.size(), file ) == m_goalRegion.size() &&
+					   fwrite( m_distancesToGoal.data(), sizeof( uint32_t ), tileCount, file ) == tileCount &&
+					   fwrite( flowPlane.data(), sizeof( uint8_t ), tileCount, file ) == tileCount );
+			result = ( fclose( file ) == 0 && result );
+		}
+
+		return result;
+	}
+
+
+	bool Flowfield::compress()
+	{
+		// Hierarchical flowfields are left as they are, since their sectors are integrated as they're read.
+		requires( isReady() && !m_isHierarchical && !m_isCompressed );
+
+		// Only keep the runs if they take less space than the planes. (In a maze, most runs are a tile or two.)
+		size_t maxRunCount = ( ( ( m_width * m_height ) * ( sizeof( FlowData ) + sizeof( unsigned int ) ) ) / sizeof( FlowRun ) );
+		std::vector< FlowRun > runs;
+		std::vector< size_t > rowStarts( m_height + 1 );
+
+		for( size_t y = 0; y < m_height && runs.size() < maxRunCount; ++y )
+		{
+			size_t rowStart = runs.size();
+			rowStarts[ y ] = rowStart;
+
+			for( size_t x = 0; x < m_width; ++x )
+			{
+				size_t index = ( ( y * m_width ) + x );
+				const FlowData& flow = getTileData( index );
+
+				// Distances are only valid for closed tiles, so every other tile can join a run whatever its distance.
+				unsigned int distanceToGoal = ( flow.isClosed() ? m_distancesToGoal[ index ] : 0 );
+				bool isInRun = false;
+
+				if( runs.size() > rowStart )
+				{
+					// Extend the last run if the tile follows on from it. The second tile of a run sets its pattern.
+					FlowRun& run = runs.back();
+					long long step = ( (long long) distanceToGoal - run.distanceToGoal );
+					size_t length = ( x - run.x );
+
+					if( length == 1 && step >= std::numeric_limits< signed char >::min() && step <= std::numeric_limits< signed char >::max() )
+					{
+						run.flows[ 1 ] = flow;
+						run.distanceStep = (signed char) step;
+						isInRun = true;
+					}
+					else if( length > 1 )
+					{
+						isInRun = ( run.flows[ length & 1 ] == flow && step == ( (long long) run.distanceStep * (long long) length ) );
+					}
+				}
+
+				if( !isInRun )
+				{
+					runs.push_back( FlowRun( (TileOffset) x, flow, distanceToGoal ) );
+				}
+			}
+		}
+
+		bool result = ( runs.size() < maxRunCount );
+
+		if( result )
+		{
+			// Keep the runs in a vector of exactly their size, and free the planes along with everything kept between builds.
+			rowStarts[ m_height ] = runs.size();
+			m_compressedRuns.assign( runs.begin(), runs.end() );
+			m_compressedRowStarts.swap( rowStarts );
+			std::vector< FlowData >().swap( m_tiles );
+			std::vector< unsigned int >().swap( m_distancesToGoal );
+			std::vector< FieldVector >().swap( m_fieldVectors );
+			std::vector< TileVector >().swap( m_tileQueue );
+			std::vector< TileVector >().swap( m_tilesToClear );
+			std::vector< unsigned int >().swap( m_queueOrders );
+			std::vector< std::vector< OpenedTile > >().swap( m_openedTilesByThread );
+			std::vector< Tile >().swap( m_repairedTiles );
+			std::vector< unsigned int >().swap( m_repairStamps );
+			m_tilesToEvaluate = MinHeap< unsigned int, Tile >();
+			m_tileBuckets = BucketQueue< Tile >();
+			m_octileBuckets = BucketQueue< OctileStep >();
+			m_isCompressed = true;
+		}
+
+		return result;
+	}
+
+
+	void Flowfield::decompress()
+	{
+		requires( m_isCompressed );
+
+		std::vector< FlowRun > runs;
+		std::vector< size_t > rowStarts;
+		runs.swap( m_compressedRuns );
+		rowStarts.swap( m_compressedRowStarts );
+		allocatePlanes();
+
+		// Expand each row's runs back into the planes.
+		for( size_t y = 0; y < m_height; ++y )
+		{
+			size_t rowEnd = rowStarts[ y + 1 ];
+
+			for( size_t i = rowStarts[ y ]; i < rowEnd; ++i )
+			{
+				const FlowRun& run = runs[ i ];
+				size_t runEnd = ( ( ( i + 1 ) < rowEnd ) ? (size_t) runs[ i + 1 ].x : m_width );
+				unsigned int distanceToGoal = run.distanceToGoal;
+
+				for( size_t x = run.x; x < runEnd; ++x )
+				{
+					size_t index = ( ( y * m_width ) + x );
+					getTileData( index ) = run.flows[ ( x - run.x ) & 1 ];
+					m_distancesToGoal[ index ] = distanceToGoal;
+					distanceToGoal += run.distanceStep;
+				}
+			}
+		}
+
+		if( m_isVectorFieldEnabled )
+		{
+			findFieldVectors();
+		}
+	}
+
+
+	void Flowfield::discard()
+	{
+		// Only a Flowfield that isn't being built can be thrown away.
+		requires( getStatus() == STATUS_READY || getStatus() == STATUS_EMPTY );
+
+		// Free the planes too. They're allocated again when the Flowfield is recalculated.
+		std::vector< FlowRun >().swap( m_compressedRuns );
+		std::vector< size_t >().swap( m_compressedRowStarts );
+		std::vector< FlowData >().swap( m_tiles );
+		std::vector< unsigned int >().swap( m_distancesToGoal );
+		std::vector< FieldVector >().swap( m_fieldVectors );
+		m_isCompressed = false;
+		setStatus( STATUS_EMPTY );
+	}
+
+
+	size_t Flowfield::getCompressedSize() const
+	{
+		return ( ( m_compressedRuns.size() * sizeof( FlowRun ) ) + ( m_compressedRowStarts.size() * sizeof( size_t ) ) );
+	}
+
+
+	void Flowfield::allocatePlanes()
+	{
+		// Bring back the planes, if the Flowfield was compressed (or discarded).
+		std::vector< FlowRun >().swap( m_compressedRuns );
+		std::vector< size_t >().swap( m_compressedRowStarts );
+		m_isCompressed = false;
+
+		if( m_tiles.size() != ( m_width * m_height ) )
+		{
+			resize( m_width, m_height );
+			m_canClearReachedTiles = false;
+		}
+
+		m_distancesToGoal.resize( m_width * m_height );
+	}
+
+
+	void Flowfield::clearFlows()
+	{
+		if( !m_canClearReachedTiles )
+		{
+			clear();
+			return;
+		}
+
+		// Clear the tiles reached from the old goals (in all eight directions, in case the Flowfield was octile), so a
+		// goal that can only reach a few tiles doesn't pay for the whole Map. Cleared tiles aren't closed anymore, so
+		// each is only found once.
+		m_tilesToClear.clear();
+
+		for( const Tile& tile : m_goalTiles )
+		{
+			getTileData( getTileIndex( tile.getPosition() ) ) = FlowData();
+			m_tilesToClear.push_back( tile.getPosition() );
+		}
+
+		while( !m_tilesToClear.empty() )
+		{
+			TileVector position = m_tilesToClear.back();
+			m_tilesToClear.pop_back();
+
+			for( int direction = CARDINAL_DIRECTION_EAST; direction <= CARDINAL_DIRECTION_SOUTHEAST; ++direction )
+			{
+				TileVector adjacentPosition = ( position + getDirectionVector( (CardinalDirection) direction ) );
+
+				if( contains( adjacentPosition ) && getTileData( getTileIndex( adjacentPosition ) ).isClosed() )
+				{
+					getTileData( getTileIndex( adjacentPosition ) ) = FlowData();
+					m_tilesToClear.push_back( adjacentPosition );
+				}
+			}
+		}
+
+		// Then forget the lines of sight, which were found from the Map rather than reached. (Only after the tiles in view
+		// were cleared, since the closed ones among them lead to others)
+		for( TileOffset y = m_lineOfSightMin.y; y <= m_lineOfSightMax.y; ++y )
+		{
+			for( TileOffset x = m_lineOfSightMin.x; x <= m_lineOfSightMax.x; ++x )
+			{
+				getTileData( getTileIndex( TileVector( x, y ) ) ) = FlowData();
+			}
+		}
+	}
+
+
+	const Flowfield::FlowRun& Flowfield::findCompressedRun( const TileVector& position ) const
+	{
+		requires( m_isCompressed && contains( position ) );
+
+		// Find the last run in the row that starts at or before the tile.
+		auto rowBegin = ( m_compressedRuns.begin() + m_compressedRowStarts[ position.y ] );
+		auto rowEnd = ( m_compressedRuns.begin() + m_compressedRowStarts[ position.y + 1 ] );
+		auto it = std::upper_bound( rowBegin, rowEnd, position.x, []( TileOffset x, const FlowRun& run )
+		{
+			return ( x < run.x );
+		} );
+
+		return *( it - 1 );
+	}
+
+
+	void Flowfield::setHierarchical( bool isHierarchical )
+	{
+		// The SectorGraph is found when the Flowfield is recalculated.
+		m_isHierarchical = isHierarchical;
+		m_sectorGraph = nullptr;
+	}
+
+
+	void Flowfield::setOctile( bool isOctile )
+	{
+		// Takes effect when the Flowfield is next recalculated. Hierarchical flowfields are always four-way,
+		// since their sectors are integrated from portals that the SectorGraph found four-way.
+		m_isOctile = isOctile;
+	}
+
+
+	void Flowfield::setLineOfSightRadius( float radius )
+	{
+		// Takes effect when the Flowfield is next recalculated (or repaired).
+		m_lineOfSightRadius = radius;
+	}
+
+
+	void Flowfield::setVectorFieldEnabled( bool isEnabled )
+	{
+		// Find (or free) the vector field right away if the Flowfield is ready. Otherwise, it's found once it's built.
+		// (Hierarchical flowfields never have one, since their sectors are only integrated as Units reach them)
+		m_isVectorFieldEnabled = isEnabled;
+
+		if( !isEnabled )
+		{
+			std::vector< FieldVector >().swap( m_fieldVectors );
+		}
+		else if( isReady() && !m_isHierarchical && !m_isCompressed )
+		{
+			findFieldVectors();
+		}
+	}
+
+
+	Vector Flowfield::sampleVectorField( float x, float y ) const
+	{
+		requires( hasVectorField() );
+
+		// Blend the vectors of the four tiles whose centers (on whole coordinates) surround the point, by how close
+		// the point is to each. Tiles off the Map, or with no way to the goal, add nothing.
+		float left = floorf( x );
+		float bottom = floorf( y );
+		float rightWeight = ( x - left );
+		float topWeight = ( y - bottom );
+		Vector result = Vector::ZERO;
+
+		for( int corner = 0; corner < 4; ++corner )
+		{
+			TileVector position( (TileOffset) ( left + ( corner & 1 ) ), (TileOffset) ( bottom + ( corner >> 1 ) ) );
+
+			if( contains( position ) )
+			{
+				const FieldVector& vector = m_fieldVectors[ getTileIndex( position ) ];
+				float weight = ( ( ( corner & 1 ) ? rightWeight : ( 1.0f - rightWeight ) ) * ( ( corner >> 1 ) ? topWeight : ( 1.0f - topWeight ) ) );
+				result += ( Vector( vector.x, vector.y ) * weight );
+			}
+		}
+
+		// Directions that mostly cancel out (e.g. on either side of a wall) leave no vector at all, rather than one
+		// scaled up from what little is left.
+		if( result.getLengthSquared() >= (float) ( MIN_BLENDED_FIELD_VECTOR_LENGTH * MIN_BLENDED_FIELD_VECTOR_LENGTH ) )
+		{
+			result.normalize();
+		}
+		else
+		{
+			result = Vector::ZERO;
+		}
+
+		return result;
+	}
+
+
+	bool Flowfield::hasLineOfSight( const ConstTile& start, const ConstTile& end, float radius ) const
+	{
+		bool result = false;
+
+		if( start.isValid() && end.isValid() )
+		{
+			TileVector goal = m_goalTile.getPosition();
+			TileVector startPosition = start.getPosition();
+			TileVector endPosition = end.getPosition();
+
+			// Every tile between the goal and a tile with a line of sight to it is clear too. So if the goal isn't between
+			// the two tiles along either axis, both are between the goal and the corner of their bounds farthest from it,
+			// and so is every tile a straight line between them passes through.
+			if( ( goal.x <= std::min( startPosition.x, endPosition.x ) || goal.x >= std::max( startPosition.x, endPosition.x ) ) &&
+				( goal.y <= std::min( startPosition.y, endPosition.y ) || goal.y >= std::max( startPosition.y, endPosition.y ) ) )
+			{
+				TileVector corner( ( std::abs( startPosition.x - goal.x ) >= std::abs( endPosition.x - goal.x ) ? startPosition.x : endPosition.x ),
+								   ( std::abs( startPosition.y - goal.y ) >= std::abs( endPosition.y - goal.y ) ? startPosition.y : endPosition.y ) );
+				result = hasLineOfSight( getTile( corner.x, corner.y ), radius );
+			}
+		}
+
+		return result;
+	}
+
+
+	void Flowfield::findLinesOfSight()
+	{
+		for( TileOffset y = m_lineOfSightMin.y; y <= m_lineOfSightMax.y; ++y )
+		{
+			// Forget the lines of sight found before.
+			for( TileOffset x = m_lineOfSightMin.x; x <= m_lineOfSightMax.x; ++x )
+			{
+				getTileData( getTileIndex( TileVector( x, y ) ) ).setLineOfSight( false );
+			}
+		}
+
+		m_lineOfSightMin = TileVector( (TileOffset) m_width, (TileOffset) m_height );
+		m_lineOfSightMax = TileVector( -1, -1 );
+
+		if( m_lineOfSightRadius < 0.0f )
+		{
+			return;
+		}
+
+		// Something of the radius anywhere in a tile overlaps no tiles farther from it than this.
+		int clearance = (int) ceilf( m_lineOfSightRadius );
+		TileVector goal = m_goalTile.getPosition();
+
+		for( int quadrant = 0; quadrant < 4; ++quadrant )
+		{
+			// Work outward from the goal a quadrant at a time. A straight line from anywhere in a tile to anywhere in the
+			// goal tile leaves the tile into its neighbor toward the goal along x or along y (or both, at the corner), so
+			// the goal is in view if nothing is in the way within the tile and the goal is in view from those neighbors.
+			TileOffset stepX = ( ( quadrant & 1 ) ? -1 : 1 );
+			TileOffset stepY = ( ( quadrant & 2 ) ? -1 : 1 );
+			TileOffset endX = ( stepX > 0 ? (TileOffset) m_width : -1 );
+			TileOffset endY = ( stepY > 0 ? (TileOffset) m_height : -1 );
+
+			for( TileOffset y = goal.y; y != endY && endX != goal.x; y += stepY )
+			{
+				TileOffset x = goal.x;
+
+				while( x != endX && isClearAround( TileVector( x, y ), clearance ) &&
+					   ( y == goal.y || getTileData( getTileIndex( TileVector( x, y - stepY ) ) ).hasLineOfSight() ) )
+				{
+					getTileData( getTileIndex( TileVector( x, y ) ) ).setLineOfSight( true );
+					x += stepX;
+				}
+
+				if( x != goal.x )
+				{
+					// Grow the bounds to cover the row.
+					TileOffset lastX = (TileOffset) ( x - stepX );
+					m_lineOfSightMin.x = std::min( m_lineOfSightMin.x, std::min( goal.x, lastX ) );
+					m_lineOfSightMin.y = std::min( m_lineOfSightMin.y, y );
+					m_lineOfSightMax.x = std::max( m_lineOfSightMax.x, std::max( goal.x, lastX ) );
+					m_lineOfSightMax.y = std::max( m_lineOfSightMax.y, y );
+				}
+
+				// Once the goal is out of view from a tile, it's out of view from every tile beyond it in the row,
+				// and so from every tile beyond those in the rows after.
+				endX = x;
+			}
+		}
+	}
+
+
+	void Flowfield::findFieldVectors()
+	{
+		m_fieldVectors.resize( m_width * m_height );
+
+		for( TileOffset y = 0; y < (TileOffset) m_height; ++y )
+		{
+			for( TileOffset x = 0; x < (TileOffset) m_width; ++x )
+			{
+				updateFieldVector( TileVector( x, y ) );
+			}
+		}
+	}
+
+
+	void Flowfield::updateFieldVector( const TileVector& position )
+	{
+		size_t index = getTileIndex( position );
+		const FlowData& flow = getTileData( index );
+		Vector vector = Vector::ZERO;
+
+		if( flow.isClosed() && !flow.isGoal() )
+		{
+			// Head down the slope of the distance to the goal, as found from the straight neighbors.
+			vector = Vector( getDescent( position, TileVector( 1, 0 ) ), getDescent( position, TileVector( 0, 1 ) ) );
+
+			if( vector.getLengthSquared() == 0.0f )
+			{
+				// On a ridge between two equally short routes, take the one the Flowfield chose.
+				TileVector direction = getDirectionVector( flow.getBestAdjacency() );
+				vector = Vector( direction.x, direction.y );
+			}
+
+			vector.normalize();
+		}
+
+		m_fieldVectors[ index ] = FieldVector( (signed char) roundf( vector.x * FIELD_VECTOR_SCALE ), (signed char) roundf( vector.y * FIELD_VECTOR_SCALE ) );
+	}
+
+
+	float Flowfield::getDescent( const TileVector& position, const TileVector& offset ) const
+	{
+		// Find how much closer to the goal each neighbor along the axis is. Neighbors that haven't been reached (such
+		// as walls) are left out, and so is a lone neighbor that's farther away, so the descent never leads into them.
+		float distance = (float) m_distancesToGoal[ getTileIndex( position ) ];
+		TileVector after = ( position + offset );
+		TileVector before = ( position - offset );
+		bool isAfterClosed = ( contains( after ) && getTileData( getTileIndex( after ) ).isClosed() );
+		bool isBeforeClosed = ( contains( before ) && getTileData( getTileIndex( before ) ).isClosed() );
+		float result = 0.0f;
+
+		if( isAfterClosed && isBeforeClosed )
+		{
+			result = ( ( (float) m_distancesToGoal[ getTileIndex( before ) ] - m_distancesToGoal[ getTileIndex( after ) ] ) * 0.5f );
+		}
+		else if( isAfterClosed )
+		{
+			result = std::max( distance - m_distancesToGoal[ getTileIndex( after ) ], 0.0f );
+		}
+		else if( isBeforeClosed )
+		{
+			result = std::min( m_distancesToGoal[ getTileIndex( before ) ] - distance, 0.0f );
+		}
+
+		return result;
+	}
+
+
+	bool Flowfield::isClearAround( const TileVector& position, int clearance ) const
+	{
+		// Only read from the Map, since this may be running on the worker thread. (Tiles off the edge of the Map are in
+		// the way, too)
+		const Map* map = m_map;
+		return map->hasClearance( Map::TileVector( position.x, position.y ), clearance );
+	}
+
+
+	void Flowfield::loadSector( size_t sector )
+	{
+		requires( m_isHierarchical && isReady() );
+		requires( m_portalNodeDistances.size() == m_sectorGraph->getNodeCount() );
+
+		if( m_loadedSectors[ sector ] )
+		{
+			// The sector has already been integrated.
+			return;
+		}
+
+		m_loadedSectors[ sector ] = true;
+		++m_loadedSectorCount;
+
+		unsigned int distances[ SectorGraph::SECTOR_TILE_COUNT ];
+		CardinalDirection bestDirections[ SectorGraph::SECTOR_TILE_COUNT ];
+		std::fill( distances, distances + SectorGraph::SECTOR_TILE_COUNT, SectorGraph::UNREACHABLE );
+		std::fill( bestDirections, bestDirections + SectorGraph::SECTOR_TILE_COUNT, CARDINAL_DIRECTION_NONE );
+		m_nodesToEvaluate.clear();
+
+		SectorGraph::TileVector goalPosition( m_goalTile.getX(), m_goalTile.getY() );
+
+		if( m_sectorGraph->sectorContains( sector, goalPosition ) )
+		{
+			// Integrate outward from the goal.
+			size_t goalIndex = m_sectorGraph->getLocalTileIndex( sector, goalPosition );
+			distances[ goalIndex ] = 0;
+			m_nodesToEvaluate.insert( 0, goalIndex );
+		}
+
+		const std::vector< size_t >& portals = m_sectorGraph->getSectorPortals( sector );
+		const Map* map = m_map;
+
+		for( size_t portalIndex : portals )
+		{
+			// Find the distance to the goal from the far side of each portal out of the sector.
+			const SectorGraph::Portal& portal = m_sectorGraph->getPortal( portalIndex );
+			size_t side = m_sectorGraph->getSideInSector( portalIndex, sector );
+			unsigned int portalDistance = m_portalNodeDistances[ SectorGraph::getNode( portalIndex, 1 - side ) ];
+
+			if( portalDistance == SectorGraph::UNREACHABLE )
+			{
+				continue;
+			}
+
+			CardinalDirection crossing = ( side == 0 ? portal.crossing : getOppositeDirection( portal.crossing ) );
+
+			for( size_t offset = 0; offset < portal.length; ++offset )
+			{
+				// Integrate inward from every tile along the portal. Only the center of the portal was searched, so estimate
+				// the distance from the other tiles by crossing the portal and following the far side of it to the center.
+				size_t centerOffset = portal.getCenterOffset();
+				unsigned int distance = portalDistance;
+
+				for( size_t i = std::min( offset, centerOffset ); i <= std::max( offset, centerOffset ); ++i )
+				{
+					distance += map->getTile( portal.getTile( 1 - side, i ) )->getCost();
+				}
+				size_t tileIndex = m_sectorGraph->getLocalTileIndex( sector, portal.getTile( side, offset ) );
+
+				if( distance < distances[ tileIndex ] )
+				{
+					distances[ tileIndex ] = distance;
+					bestDirections[ tileIndex ] = crossing;
+					m_nodesToEvaluate.insert( distance, tileIndex );
+				}
+			}
+		}
+
+		SectorGraph::TileVector origin = m_sectorGraph->getSectorOrigin( sector );
+
+		while( !m_nodesToEvaluate.isEmpty() )
+		{
+			// Pop the closest tile, skipping any that were since reached by a shorter route.
+			unsigned int distance = m_nodesToEvaluate.peekMinKey();
+			size_t tileIndex = m_nodesToEvaluate.popMinElement();
+
+			if( distance > distances[ tileIndex ] )
+			{
+				continue;
+			}
+
+			SectorGraph::TileVector position( origin.x + (TileOffset) ( tileIndex % SectorGraph::SECTOR_SIZE ), origin.y + (TileOffset) ( tileIndex / SectorGraph::SECTOR_SIZE ) );
+			unsigned int adjacentDistance = ( distance + map->getTile( position )->getCost() );
+			CardinalDirection direction = CARDINAL_DIRECTION_EAST;
+			++m_statistics.tilesExpanded;
+
+			for( size_t i = 0; i < CARDINAL_DIRECTION_COUNT; ++i )
+			{
+				SectorGraph::TileVector adjacentPosition = ( position + Map::getDirectionVector( direction ) );
+
+				if( m_sectorGraph->sectorContains( sector, adjacentPosition ) && map->getTile( adjacentPosition )->isPassable() )
+				{
+					size_t adjacentIndex = m_sectorGraph->getLocalTileIndex( sector, adjacentPosition );
+
+					if( adjacentDistance < distances[ adjacentIndex ] )
+					{
+						// Head back toward this tile from the adjacent tile.
+						distances[ adjacentIndex ] = adjacentDistance;
+						bestDirections[ adjacentIndex ] = getOppositeDirection( direction );
+						m_nodesToEvaluate.insert( adjacentDistance, adjacentIndex );
+					}
+				}
+
+				direction = getCounterClockwiseDirection( direction );
+			}
+		}
+
+		for( size_t tileIndex = 0; tileIndex < SectorGraph::SECTOR_TILE_COUNT; ++tileIndex )
+		{
+			if( distances[ tileIndex ] != SectorGraph::UNREACHABLE )
+			{
+				// Store the results for each tile that was reached.
+				Tile tile = getTile( origin.x + (TileOffset) ( tileIndex % SectorGraph::SECTOR_SIZE ), origin.y + (TileOffset) ( tileIndex / SectorGraph::SECTOR_SIZE ) );
+				setDistanceToGoal( tile, distances[ tileIndex ] );
+				tile->setClosed( true );
+
+				tile->setBestAdjacency( bestDirections[ tileIndex ] );
+			}
+		}
+	}
+
+
+	void Flowfield::reloadSector( size_t sector )
+	{
+		requires( m_isHierarchical && isReady() );
 
+		if( m_loadedSectors[ sector ] )
+		{
+			// Integrate the sector again from its portals, e.g. after the cost of its tiles has changed.
+			m_loadedSectors[ sector ] = false;
+			--m_loadedSectorCount;
+			loadSector( sector );
+		}
+	}
 
-	void Flowfield::recalculate()
+
+	void Flowfield::loadSectorAt( const TileVector& position )
 	{
-		// Clear any existing data.
-		clear();
+		if( contains( position ) )
+		{
+			loadSector( m_sectorGraph->getSectorIndex( SectorGraph::TileVector( position.x, position.y ) ) );
+		}
+	}
+
+
+	void Flowfield::loadSectorsAlongRoute( const TileVector& start )
+	{
+		if( !contains( start ) )
+		{
+			return;
+		}
+
+		Tile tile = getTile( start );
+
+		for( size_t i = 0; i < m_sectorGraph->getSectorCount(); ++i )
+		{
+			// Load the sector the route is in.
+			size_t sector = m_sectorGraph->getSectorIndex( SectorGraph::TileVector( tile.getX(), tile.getY() ) );
+			loadSector( sector );
+
+			// Follow the route to the next sector.
+			for( size_t step = 0; step < SectorGraph::SECTOR_TILE_COUNT && !tile->isGoal() &&
+				 m_sectorGraph->getSectorIndex( SectorGraph::TileVector( tile.getX(), tile.getY() ) ) == sector; ++step )
+			{
+				CardinalDirection bestDirection = tile->getBestAdjacency();
+
+				if( bestDirection == CARDINAL_DIRECTION_NONE )
+				{
+					break;
+				}
+
+				tile = tile.getAdjacentTile( bestDirection );
+			}
+
+			if( m_sectorGraph->getSectorIndex( SectorGraph::TileVector( tile.getX(), tile.getY() ) ) == sector )
+			{
+				// Stop once the route reaches the goal (or a dead end).
+				break;
+			}
+		}
+	}
+
+
+	Flowfield::IntegrationMethod Flowfield::chooseIntegrationMethod() const
+	{
+		IntegrationMethod result = m_integrationMethod;
+
+		if( m_isOctile )
+		{
+			// Straight and diagonal steps cost different amounts, so only the buckets (which
+			// keep the two apart) reach each tile from its closest neighbor first.
+			result = INTEGRATION_METHOD_BUCKETS;
+		}
+		else if( m_map->hasWeightedTiles() )
+		{
+			if( result == INTEGRATION_METHOD_AUTOMATIC || result == INTEGRATION_METHOD_QUEUE || result == INTEGRATION_METHOD_PARALLEL )
+			{
+				// Tiles only leave a FIFO queue in order of distance when every tile costs the same. Tile
+				// costs are small integers, though, so a bucket per distance works nearly as well.
+				result = INTEGRATION_METHOD_BUCKETS;
+			}
+		}
+		else if( result == INTEGRATION_METHOD_AUTOMATIC )
+		{
+			// Every step between adjacent tiles costs exactly 1, so tiles leave a FIFO queue
+			// in order of distance and the heap isn't needed.
+			result = INTEGRATION_METHOD_QUEUE;
+
+			if( ( m_width * m_height ) >= PARALLEL_INTEGRATION_MIN_TILES && m_map->getThreadPool()->getThreadCount() > 1 &&
+				std::thread::hardware_concurrency() > 1 )
+			{
+				// Large fields have wavefronts wide enough to share between threads. (On a single core, the threads
+				// would only take turns and pay for the barriers, so the queue stays faster even if the pool was
+				// given more threads)
+				result = INTEGRATION_METHOD_PARALLEL;
+			}
+		}
+
+		return result;
+	}
+
+
+	bool Flowfield::integrateWithQueue( size_t maxTileCount )
+	{
+		// Pick up the queue where the last call left it, and expand no more than the given number of tiles.
+		size_t head = m_tileQueueHead;
+		size_t tail = m_tileQueueTail;
+		size_t headLimit = ( head + std::min( maxTileCount, m_tileQueue.size() - head ) );
+
+		// Only read from the Map, since this may be running on the worker thread.
+		const Map* map = m_map;
+
+		while( head < tail && head < headLimit )
+		{
+			// Pop the oldest (and therefore closest) tile and evaluate it. This works on the
+			// FlowData and distance planes directly, since it touches every reachable tile.
+			TileVector position = m_tileQueue[ head++ ];
+			unsigned int adjacentDistanceToGoal = ( m_distancesToGoal[ getTileIndex( position ) ] + 1 );
+			CardinalDirection direction = CARDINAL_DIRECTION_EAST;
+
+			for( size_t i = 0; i < CARDINAL_DIRECTION_COUNT; ++i )
+			{
+				TileVector adjacentPosition = ( position + getDirectionVector( direction ) );
+
+				if( contains( adjacentPosition ) && map->getTile( adjacentPosition.x, adjacentPosition.y )->isPassable() )
+				{
+					size_t adjacentIndex = getTileIndex( adjacentPosition );
+					FlowData& adjacentData = getTileData( adjacentIndex );
+
+					if( adjacentData.getBestAdjacency() == CARDINAL_DIRECTION_NONE )
+					{
+						// Tiles leave the queue closest first, so the first tile to reach this one is the best way back to the goal.
+						adjacentData.setBestAdjacency( getOppositeDirection( direction ) );
+					}
+
+					if( !adjacentData.isClosed() )
+					{
+						// Close the tile and queue it.
+						adjacentData.setClosed( true );
+						m_distancesToGoal[ adjacentIndex ] = adjacentDistanceToGoal;
+						m_tileQueue[ tail++ ] = adjacentPosition;
+					}
+				}
+
+				// Go to the next tile direction to evaluate.
+				direction = getCounterClockwiseDirection( direction );
+			}
+		}
+
+		// Every tile is pushed and popped once.
+		m_statistics.tilesExpanded += ( head - m_tileQueueHead );
+		m_statistics.queueOperations += ( ( head - m_tileQueueHead ) + ( tail - m_tileQueueTail ) );
+
+		m_tileQueueHead = head;
+		m_tileQueueTail = tail;
+		return ( head == tail );
+	}
+
+
+	bool Flowfield::integrateInParallel( size_t maxTileCount )
+	{
+		// Tiles are queued in exactly the same order as integrateWithQueue() would queue them. Only whole
+		// wavefronts are expanded, so this stops at the first one to reach the given number of tiles.
+		size_t firstHead = m_tileQueueHead;
+		size_t firstTail = m_tileQueueTail;
+		size_t head = firstHead;
+		size_t tail = firstTail;
+		size_t headLimit = ( head + std::min( maxTileCount, m_tileQueue.size() - head ) );
+
+		// Only read from the Map, since this may be running on the worker thread.
+		ThreadPool* threadPool = m_map->getThreadPool();
+		const Map* map = m_map;
+
+		while( head < tail && head < headLimit )
+		{
+			// The tiles between the head and tail of the queue are always one whole wavefront: every tile the same distance from the goal.
+			size_t threadCount = threadPool->getThreadCount();
+
+			if( ( tail - head ) >= PARALLEL_MIN_WAVEFRONT_SIZE && threadCount > 1 )
+			{
+				// Split the wavefronts between the threads until they get small again.
+				ThreadBarrier barrier( threadCount );
+				m_openedTilesByThread.resize( threadCount );
+				m_tileQueueHead = head;
+				m_tileQueueTail = tail;
+
+				threadPool->run( [ this, threadCount, &barrier, headLimit ]( size_t threadIndex )
+				{
+					integrateWavefronts( threadIndex, threadCount, barrier, headLimit );
+				} );
+
+				head = m_tileQueueHead;
+				tail = m_tileQueueTail;
+			}
+			else
+			{
+				// Expand the whole wavefront on this thread, the same way integrateWithQueue() does.
+				size_t wavefrontEnd = tail;
+
+				while( head < wavefrontEnd )
+				{
+					TileVector position = m_tileQueue[ head++ ];
+					unsigned int adjacentDistanceToGoal = ( m_distancesToGoal[ getTileIndex( position ) ] + 1 );
+					CardinalDirection direction = CARDINAL_DIRECTION_EAST;
+
+					for( size_t i = 0; i < CARDINAL_DIRECTION_COUNT; ++i )
+					{
+						TileVector adjacentPosition = ( position + getDirectionVector( direction ) );
+
+						if( contains( adjacentPosition ) && map->getTile( adjacentPosition.x, adjacentPosition.y )->isPassable() )
+						{
+							size_t adjacentIndex = getTileIndex( adjacentPosition );
+							FlowData& adjacentData = getTileData( adjacentIndex );
+
+							if( adjacentData.getBestAdjacency() == CARDINAL_DIRECTION_NONE )
+							{
+								adjacentData.setBestAdjacency( getOppositeDirection( direction ) );
+							}
+
+							if( !adjacentData.isClosed() )
+							{
+								// Close the tile and queue it, remembering where it was queued.
+								adjacentData.setClosed( true );
+								m_distancesToGoal[ adjacentIndex ] = adjacentDistanceToGoal;
+								m_queueOrders[ adjacentIndex ] = (unsigned int) tail;
+								m_tileQueue[ tail++ ] = adjacentPosition;
+							}
+						}
+
+						// Go to the next tile direction to evaluate.
+						direction = getCounterClockwiseDirection( direction );
+					}
+				}
+			}
+		}
+
+		// Every tile is pushed and popped once, just as with the queue.
+		m_statistics.tilesExpanded += ( head - firstHead );
+		m_statistics.queueOperations += ( ( head - firstHead ) + ( tail - firstTail ) );
+
+		m_tileQueueHead = head;
+		m_tileQueueTail = tail;
+		return ( head == tail );
+	}
+
+
+	void Flowfield::integrateWavefronts( size_t threadIndex, size_t threadCount, ThreadBarrier& barrier, size_t headLimit )
+	{
+		requires( threadIndex < threadCount );
+
+		// Every thread steps through the same wavefronts, so each keeps its own copy of where the current one
+		// is. (Every thread reads the ends of the queue before the first barrier, and thread 0 only writes them back at the end.)
+		size_t wavefrontBegin = m_tileQueueHead;
+		size_t wavefrontEnd = m_tileQueueTail;
+		unsigned int adjacentDistanceToGoal = ( m_distancesToGoal[ getTileIndex( m_tileQueue[ wavefrontBegin ] ) ] + 1 );
+		std::vector< OpenedTile >& openedTiles = m_openedTilesByThread[ threadIndex ];
+		const Map* map = m_map;
+
+		while( ( wavefrontEnd - wavefrontBegin ) >= ( PARALLEL_MIN_WAVEFRONT_SIZE / 2 ) && wavefrontBegin < headLimit )
+		{
+			// Find the tiles that this thread's share of the wavefront reaches before any other
+			// tile in the queue does. Nothing is closed until every thread has looked.
+			size_t wavefrontSize = ( wavefrontEnd - wavefrontBegin );
+			size_t first = ( wavefrontBegin + ( wavefrontSize * threadIndex ) / threadCount );
+			size_t last = ( wavefrontBegin + ( wavefrontSize * ( threadIndex + 1 ) ) / threadCount );
+			openedTiles.clear();
+
+			for( size_t queueOrder = first; queueOrder < last; ++queueOrder )
+			{
+				TileVector position = m_tileQueue[ queueOrder ];
+				CardinalDirection direction = CARDINAL_DIRECTION_EAST;
+
+				for( size_t i = 0; i < CARDINAL_DIRECTION_COUNT; ++i )
+				{
+					TileVector adjacentPosition = ( position + getDirectionVector( direction ) );
+
+					if( contains( adjacentPosition ) && map->getTile( adjacentPosition.x, adjacentPosition.y )->isPassable() &&
+						!getTileData( getTileIndex( adjacentPosition ) ).isClosed() && isFirstToReach( adjacentPosition, (unsigned int) queueOrder ) )
+					{
+						openedTiles.push_back( OpenedTile( adjacentPosition, getOppositeDirection( direction ) ) );
+					}
+
+					direction = getCounterClockwiseDirection( direction );
+				}
+			}
+
+			barrier.wait();
+
+			// Queue the opened tiles after the ones opened by earlier shares of the wavefront, which
+			// is where a single thread would have queued them, and close them.
+			size_t queueOrder = wavefrontEnd;
+			size_t openedTileCount = 0;
+
+			for( size_t i = 0; i < threadCount; ++i )
+			{
+				if( i < threadIndex )
+				{
+					queueOrder += m_openedTilesByThread[ i ].size();
+				}
+
+				openedTileCount += m_openedTilesByThread[ i ].size();
+			}
+
+			for( const OpenedTile& openedTile : openedTiles )
+			{
+				size_t index = getTileIndex( openedTile.position );
+				FlowData& data = getTileData( index );
+				data.setClosed( true );
+				data.setBestAdjacency( openedTile.bestAdjacency );
+
+				m_distancesToGoal[ index ] = adjacentDistanceToGoal;
+				m_queueOrders[ index ] = (unsigned int) queueOrder;
+				m_tileQueue[ queueOrder++ ] = openedTile.position;
+			}
+
+			barrier.wait();
+
+			// Move on to the wavefront that was just queued.
+			wavefrontBegin = wavefrontEnd;
+			wavefrontEnd += openedTileCount;
+			++adjacentDistanceToGoal;
+		}
+
+		if( threadIndex == 0 )
+		{
+			// Hand the rest of the queue back to the calling thread.
+			m_tileQueueHead = wavefrontBegin;
+			m_tileQueueTail = wavefrontEnd;
+		}
+	}
+
+
+	bool Flowfield::isFirstToReach( const TileVector& position, unsigned int queueOrder ) const
+	{
+		// Every closed tile next to one that is still open is in the current wavefront, and a
+		// single thread would expand those in queue order. So the earliest of them reaches it first.
+		bool result = true;
+		CardinalDirection direction = CARDINAL_DIRECTION_EAST;
+
+		for( size_t i = 0; i < CARDINAL_DIRECTION_COUNT && result; ++i )
+		{
+			TileVector adjacentPosition = ( position + getDirectionVector( direction ) );
+
+			if( contains( adjacentPosition ) )
+			{
+				size_t adjacentIndex = getTileIndex( adjacentPosition );
+				result = ( !getTileData( adjacentIndex ).isClosed() || m_queueOrders[ adjacentIndex ] >= queueOrder );
+			}
+
+			direction = getCounterClockwiseDirection( direction );
+		}
+
+		return result;
+	}
 
-		// Add goal location.
-		m_goalTile->setGoal( true );
-		m_goalTile->setClosed( true );
-		m_tilesToEvaluate.insert( 0, m_goalTile );
 
-		while( m_tilesToEvaluate.getSize() > 0 )
+	bool Flowfield::integrateWithHeap( size_t maxTileCount )
+	{
+		// Pick up the heap where the last call left it, and expand no more than the given number of tiles.
+		for( size_t expandedTileCount = 0; expandedTileCount < maxTileCount && m_tilesToEvaluate.getSize() > 0; ++expandedTileCount )
 		{
 			// Pop the tile with the minimum goal distance and evaluate it.
 			Tile tile = m_tilesToEvaluate.popMinElement();
+			++m_statistics.tilesExpanded;
+			++m_statistics.queueOperations;
 			CardinalDirection direction = CARDINAL_DIRECTION_EAST;
 
 			for( int i = 0; i < CARDINAL_DIRECTION_COUNT; ++i )
 			{
-				// Evaluate the adjacent tile.
-				evaluateTile( tile, direction );
+				// Evaluate the adjacent tile, and add it to the heap if it was just opened.
+				Tile adjacentTile;
+
+				if( evaluateTile( tile, direction, adjacentTile ) )
+				{
+					m_tilesToEvaluate.insert( getDistanceToGoal( adjacentTile ) + getTileCost( adjacentTile.getPosition() ), adjacentTile );
+					++m_statistics.queueOperations;
+				}
+
+				// Go to the next tile direction to evaluate.
+				direction = getCounterClockwiseDirection( direction );
+			}
+		}
+
+		return ( m_tilesToEvaluate.getSize() == 0 );
+	}
+
+
+	bool Flowfield::integrateWithBuckets( size_t maxTileCount )
+	{
+		// Pick up the buckets where the last call left them, and expand no more than the given number of tiles.
+		for( size_t expandedTileCount = 0; expandedTileCount < maxTileCount && !m_tileBuckets.isEmpty(); ++expandedTileCount )
+		{
+			// Pop a tile from the bucket with the minimum key and evaluate it.
+			Tile tile = m_tileBuckets.popMinElement();
+			++m_statistics.tilesExpanded;
+			++m_statistics.queueOperations;
+			CardinalDirection direction = CARDINAL_DIRECTION_EAST;
+
+			for( size_t i = 0; i < CARDINAL_DIRECTION_COUNT; ++i )
+			{
+				// Evaluate the adjacent tile, and add it to a bucket if it was just opened.
+				Tile adjacentTile;
+
+				if( evaluateTile( tile, direction, adjacentTile ) )
+				{
+					m_tileBuckets.insert( getDistanceToGoal( adjacentTile ) + getTileCost( adjacentTile.getPosition() ), adjacentTile );
+					++m_statistics.queueOperations;
+				}
 
 				// Go to the next tile direction to evaluate.
 				direction = getCounterClockwiseDirection( direction );
 			}
 		}
+
+		return m_tileBuckets.isEmpty();
+	}
+
+
+	bool Flowfield::integrateOctile( size_t maxTileCount )
+	{
+		// Every closed tile is in the buckets twice: once keyed by the distance it offers its straight neighbors,
+		// and once by the larger distance it offers its diagonal ones. Popping the smallest offer of either kind
+		// first means each tile is still reached first by the neighbor it is closest to the goal through.
+		for( size_t expandedTileCount = 0; expandedTileCount < maxTileCount && !m_octileBuckets.isEmpty(); ++expandedTileCount )
+		{
+			OctileStep step = m_octileBuckets.popMinElement();
+			++m_statistics.tilesExpanded;
+			++m_statistics.queueOperations;
+			CardinalDirection direction = ( step.isDiagonal ? CARDINAL_DIRECTION_NORTHEAST : CARDINAL_DIRECTION_EAST );
+
+			for( size_t i = 0; i < CARDINAL_DIRECTION_COUNT; ++i )
+			{
+				// Evaluate the adjacent tile in each of the four straight (or diagonal) directions, and add both
+				// of its offers to the buckets if it was just opened.
+				Tile adjacentTile;
+
+				if( evaluateTile( step.tile, direction, adjacentTile ) )
+				{
+					TileVector position = adjacentTile.getPosition();
+					unsigned int distance = getDistanceToGoal( adjacentTile );
+					m_octileBuckets.insert( distance + getStepCost( position, CARDINAL_DIRECTION_EAST ), OctileStep( adjacentTile, false ) );
+					m_octileBuckets.insert( distance + getStepCost( position, CARDINAL_DIRECTION_NORTHEAST ), OctileStep( adjacentTile, true ) );
+					m_statistics.queueOperations += 2;
+				}
+
+				// Turn to the next straight (or diagonal) direction.
+				direction = getCounterClockwiseDirection( direction );
+			}
+		}
+
+		return m_octileBuckets.isEmpty();
+	}
+
+
+	void Flowfield::integrateSectorGraph()
+	{
+		requires( m_sectorGraph );
+
+		// Find the distance to the goal from every tile in its sector.
+		SectorGraph::TileVector goalPosition( m_goalTile.getX(), m_goalTile.getY() );
+		size_t goalSector = m_sectorGraph->getSectorIndex( goalPosition );
+		std::vector< unsigned int > distances;
+		m_sectorGraph->findSectorDistances( goalSector, goalPosition, distances );
+
+		m_portalNodeDistances.assign( m_sectorGraph->getNodeCount(), SectorGraph::UNREACHABLE );
+		m_nodesToEvaluate.clear();
+
+		for( size_t portalIndex : m_sectorGraph->getSectorPortals( goalSector ) )
+		{
+			// Start the search from each portal out of the goal sector.
+			size_t side = m_sectorGraph->getSideInSector( portalIndex, goalSector );
+			size_t node = SectorGraph::getNode( portalIndex, side );
+			unsigned int distance = distances[ m_sectorGraph->getLocalTileIndex( goalSector, m_sectorGraph->getPortal( portalIndex ).getCenter( side ) ) ];
+
+			if( distance < m_portalNodeDistances[ node ] )
+			{
+				m_portalNodeDistances[ node ] = distance;
+				m_nodesToEvaluate.insert( distance, node );
+				++m_statistics.queueOperations;
+			}
+		}
+
+		while( !m_nodesToEvaluate.isEmpty() )
+		{
+			// Pop the closest portal node (skipping any that were since reached by a shorter route).
+			unsigned int distance = m_nodesToEvaluate.peekMinKey();
+			size_t node = m_nodesToEvaluate.popMinElement();
+			++m_statistics.queueOperations;
+
+			if( distance > m_portalNodeDistances[ node ] )
+			{
+				continue;
+			}
+
+			for( const SectorGraph::Edge& edge : m_sectorGraph->getNodeEdges( node ) )
+			{
+				unsigned int edgeDistance = ( distance + edge.cost );
+
+				if( edgeDistance < m_portalNodeDistances[ edge.node ] )
+				{
+					m_portalNodeDistances[ edge.node ] = edgeDistance;
+					m_nodesToEvaluate.insert( edgeDistance, edge.node );
+					++m_statistics.queueOperations;
+				}
+			}
+		}
+
+		// Forget any sectors loaded for the previous goal.
+		m_loadedSectors.assign( m_sectorGraph->getSectorCount(), false );
+		m_loadedSectorCount = 0;
 	}
 
 
-	void Flowfield::evaluateTile( Tile tile, CardinalDirection direction )
+	bool Flowfield::evaluateTile( Tile tile, CardinalDirection direction, Tile& adjacentTile )
 	{
+		bool wasOpened = false;
+
 		// Get the next adjacent tile from this one.
-		Tile adjacentTile = tile.getAdjacentTile( direction );
+		adjacentTile = tile.getAdjacentTile( direction );
 
 		if( adjacentTile.isValid() )
 		{
 			// If this node hasn't already been visited, get the Map tile for the adjacent tile.
+			// Only read from the Map, since this may be running on the worker thread.
 			TileVector position = adjacentTile.getPosition();
-			Map::Tile mapTile = m_map->getTile( position.x, position.y );
+			const Map* map = m_map;
+			Map::ConstTile mapTile = map->getTile( position.x, position.y );
 
-			if( mapTile->isPassable() )
+			if( mapTile->isPassable() && !cutsCorner( tile.getPosition(), direction ) )
 			{
-				// Add adjacency information for this tile.
-				adjacentTile->addAdjacency( getOppositeDirection( direction ) );
+				if( adjacentTile->getBestAdjacency() == CARDINAL_DIRECTION_NONE )
+				{
+					// Tiles are evaluated in order of the distance they offer their neighbors, so the first
+					// tile to reach this one is the best way back to the goal.
+					adjacentTile->setBestAdjacency( getOppositeDirection( direction ) );
+				}
 
 				if( !adjacentTile->isClosed() )
 				{
 					// Close the tile.
 					adjacentTile->setClosed( true );
 
-					// Calculate the distance to the goal.
-					unsigned int adjacentDistanceToGoal = ( tile->getDistanceToGoal() + 1 );
-					adjacentTile->setDistanceToGoal( adjacentDistanceToGoal );
+					// Calculate the distance to the goal, which starts by stepping back onto the tile that reached this one.
+					unsigned int adjacentDistanceToGoal = ( getDistanceToGoal( tile ) + getStepCost( tile.getPosition(), direction ) );
+					setDistanceToGoal( adjacentTile, adjacentDistanceToGoal );
+
+					// Let the caller add the tile to the list of tiles to be evaluated.
+					wasOpened = true;
+				}
+			}
+		}
+
+		return wasOpened;
+	}
+
+
+	void Flowfield::invalidateTile( Tile tile )
+	{
+		// Mark the tile, so its distance is found again.
+		m_repairStamps[ getTileIndex( tile.getPosition() ) ] = m_repairStamp;
+		m_repairedTiles.push_back( tile );
+
+		if( tile->isClosed() )
+		{
+			CardinalDirection direction = CARDINAL_DIRECTION_EAST;
+
+			for( size_t i = 0; i < getDirectionCount(); ++i )
+			{
+				// Any neighbor one step (at this tile's cost) farther from the goal may have been reached through this tile.
+				Tile adjacentTile = tile.getAdjacentTile( direction );
+
+				if( adjacentTile.isValid() && adjacentTile->isClosed() && !adjacentTile->isGoal() &&
+					getDistanceToGoal( adjacentTile ) == ( getDistanceToGoal( tile ) + getStepCost( tile.getPosition(), direction ) ) )
+				{
+					m_tilesToEvaluate.insert( getDistanceToGoal( adjacentTile ), adjacentTile );
+					++m_statistics.queueOperations;
+				}
+
+				direction = getNextDirection( direction );
+			}
+		}
+	}
+
+
+	bool Flowfield::isInvalidated( const Tile& tile ) const
+	{
+		return ( m_repairStamps[ getTileIndex( tile.getPosition() ) ] == m_repairStamp );
+	}
+
+
+	void Flowfield::updateBestAdjacency( Tile tile )
+	{
+		tile->setBestAdjacency( CARDINAL_DIRECTION_NONE );
+
+		// Only reachable, passable tiles have adjacencies.
+		TileVector position = tile.getPosition();
+		const Map* map = m_map;
+
+		if( !tile->isClosed() || !map->getTile( position.x, position.y )->isPassable() )
+		{
+			return;
+		}
+
+		unsigned int bestDistance = 0;
+		CardinalDirection direction = CARDINAL_DIRECTION_EAST;
+
+		for( size_t i = 0; i < getDirectionCount(); ++i )
+		{
+			// Head toward the neighbor with the shortest route to the goal, counting the cost of stepping onto it.
+			Tile adjacentTile = tile.getAdjacentTile( direction );
 
-					// Add the tile to the list of tiles to be evaluated.
-					m_tilesToEvaluate.insert( adjacentDistanceToGoal, adjacentTile );
+			if( adjacentTile.isValid() && adjacentTile->isClosed() && !cutsCorner( position, direction ) )
+			{
+				unsigned int distance = ( getDistanceToGoal( adjacentTile ) + getStepCost( adjacentTile.getPosition(), direction ) );
+
+				if( tile->getBestAdjacency() == CARDINAL_DIRECTION_NONE || distance < bestDistance )
+				{
+					tile->setBestAdjacency( direction );
+					bestDistance = distance;
 				}
 			}
+
+			direction = getNextDirection( direction );
 		}
 	}
 
@@ -97,4 +1818,17 @@ namespace atc
 	{
 		return m_goalTile;
 	}
+
+
+	void Flowfield::setGoalRegion( const std::vector< TileVector >& positions )
+	{
+		// Takes effect when the Flowfield is next recalculated.
+		m_goalRegion = positions;
+	}
+
+
+	const std::vector< Flowfield::TileVector >& Flowfield::getGoalRegion() const
+	{
+		return m_goalRegion;
+	}
 }
\ No newline at end of file
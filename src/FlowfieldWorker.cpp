@@ -0,0 +1,135 @@
+#include "common.h"
+#include "FlowfieldWorker.h"
+
+namespace atc
+{
+	FlowfieldWorker::FlowfieldWorker() :
+		m_currentJob( nullptr ),
+		m_isStopping( false )
+	{ }
+
+
+	FlowfieldWorker::~FlowfieldWorker()
+	{
+		stop();
+	}
+
+
+	void FlowfieldWorker::submit( Flowfield* flowfield )
+	{
+		requires( flowfield );
+
+		// Start the thread the first time it is needed.
+		if( !isRunning() )
+		{
+			start();
+		}
+
+		std::unique_lock< std::mutex > lock( m_mutex );
+
+		// If the Flowfield is being rebuilt right now, let that finish before it is rebuilt again.
+		m_jobFinished.wait( lock, [ this, flowfield ] { return ( m_currentJob != flowfield ); } );
+
+		if( std::find( m_jobs.begin(), m_jobs.end(), flowfield ) == m_jobs.end() )
+		{
+			// Queue the Flowfield, and unpublish it until it has been rebuilt.
+			flowfield->setStatus( Flowfield::STATUS_QUEUED );
+			m_jobs.push_back( flowfield );
+			m_jobSubmitted.notify_one();
+		}
+	}
+
+
+	void FlowfieldWorker::cancel( Flowfield* flowfield )
+	{
+		std::unique_lock< std::mutex > lock( m_mutex );
+
+		// Remove the Flowfield from the queue if it hasn't been started yet.
+		auto it = std::find( m_jobs.begin(), m_jobs.end(), flowfield );
+
+		if( it != m_jobs.end() )
+		{
+			m_jobs.erase( it );
+			flowfield->setStatus( Flowfield::STATUS_EMPTY );
+		}
+
+		// Otherwise, wait for the worker to finish with it.
+		m_jobFinished.wait( lock, [ this, flowfield ] { return ( m_currentJob != flowfield ); } );
+	}
+
+
+	void FlowfieldWorker::waitUntilIdle()
+	{
+		std::unique_lock< std::mutex > lock( m_mutex );
+		m_jobFinished.wait( lock, [ this ] { return ( m_jobs.empty() && m_currentJob == nullptr ); } );
+	}
+
+
+	bool FlowfieldWorker::isIdle() const
+	{
+		std::lock_guard< std::mutex > lock( m_mutex );
+		return ( m_jobs.empty() && m_currentJob == nullptr );
+	}
+
+
+	void FlowfieldWorker::stop()
+	{
+		if( isRunning() )
+		{
+			{
+				// Tell the thread to exit once it finishes its current job.
+				std::lock_guard< std::mutex > lock( m_mutex );
+				m_isStopping = true;
+				m_jobSubmitted.notify_one();
+			}
+
+			m_thread.join();
+
+			// Drop any jobs that never started.
+			for( Flowfield* flowfield : m_jobs )
+			{
+				flowfield->setStatus( Flowfield::STATUS_EMPTY );
+			}
+
+			m_jobs.clear();
+			m_isStopping = false;
+		}
+	}
+
+
+	void FlowfieldWorker::start()
+	{
+		requires( !isRunning() );
+		m_thread = std::thread( &FlowfieldWorker::run, this );
+	}
+
+
+	void FlowfieldWorker::run()
+	{
+		std::unique_lock< std::mutex > lock( m_mutex );
+
+		while( true )
+		{
+			// Sleep until there is a job to do.
+			m_jobSubmitted.wait( lock, [ this ] { return ( m_isStopping || !m_jobs.empty() ); } );
+
+			if( m_isStopping )
+			{
+				break;
+			}
+
+			// Take the oldest job, and rebuild the Flowfield without holding the lock.
+			Flowfield* flowfield = m_jobs.front();
+			m_jobs.pop_front();
+			m_currentJob = flowfield;
+
+			lock.unlock();
+			flowfield->recalculate();
+			lock.lock();
+
+			// Let anyone waiting on this Flowfield know that it's finished.
+			m_currentJob = nullptr;
+			m_jobFinished.notify_all();
+		}
+	}
+}
@@ -36,6 +36,7 @@ namespace atc
 		m_index( index ),
 		m_color( color ),
 		m_wasModified( false ),
+		m_hasLoadedFlowfieldRoute( false ),
 		m_origin( origin ),
 		m_destination( destination ),
 		m_world( world ),
@@ -51,17 +52,11 @@ namespace atc
 		}
 
 		m_facingAngle = facing;
+		m_arrivalFacingAngle = facing;
 
-		// Set the behavior for this Formation.
+		// Set the behavior for this Formation. Its Flowfield is found once Units have joined
+		// and the slots are laid out, on the first update.
 		setBehavior( behavior );
-
-		// Create a flowfield toward the goal of the Formation.
-		m_flowfield = m_world->getMap()->createFlowfield();
-
-		Map::TileVector goalPosition = m_world->worldToTileCoords( destination );
-		Flowfield::Tile goalTile = m_flowfield->getTile( goalPosition.x, goalPosition.y );
-		m_flowfield->setGoalTile( goalTile );
-		m_flowfield->recalculate();
 	}
 
 
@@ -69,8 +64,8 @@ namespace atc
 	{
 		if( hasFlowfield() )
 		{
-			// If this Formation has a Flowfield, destroy it.
-			m_flowfield->destroy();
+			// If this Formation has a Flowfield, let the Map know it's no longer needed.
+			m_world->getMap()->releaseFlowfield( m_flowfield );
 			m_flowfield = nullptr;
 		}
 	}
@@ -78,6 +73,26 @@ namespace atc
 
 	void Formation::update( double elapsedTime )
 	{
+		if( hasFlowfield() && m_flowfield->getStatus() == Flowfield::STATUS_EMPTY )
+		{
+			// The Map threw the Flowfield away when it was resized, so find a new one.
+			m_world->getMap()->releaseFlowfield( m_flowfield );
+			m_flowfield = nullptr;
+		}
+
+		if( !hasFlowfield() )
+		{
+			// Lay out the slots for the Units that joined since the Formation was created, which finds the Flowfield.
+			recalculate();
+			m_wasModified = false;
+		}
+
+		if( m_flowfield->isReady() && m_flowfield->isHierarchical() )
+		{
+			// Make sure the flowfield has been integrated wherever it's about to be read.
+			loadFlowfieldSectors();
+		}
+
 		// Find the movement speed of the slowest unit.
 		float maximumMoveSpeed = m_units.calculateMaximumMoveSpeed();
 
@@ -91,20 +106,30 @@ namespace atc
 		Map::TileVector tilePos = m_world->worldToTileCoords( m_origin );
 		Map::Tile mapTile = map->getTile( tilePos );
 
+		// Skip the trace wherever the Flowfield already knows the goal is in view.
 		if( mapTile.isValid() && mapTile->isPassable() &&
+			!getFlowfield()->hasLineOfSight( getFlowfield()->getTile( tilePos.x, tilePos.y ), Unit::TRACE_RADIUS ) &&
 			!m_world->traceIsPassable( m_origin, m_destination, Unit::TRACE_RADIUS ) )
 		{
-			// Get the best adjacency from this location.
-			Flowfield::Tile flowfieldTile = m_flowfield->getTile( tilePos.x, tilePos.y );
+			Flowfield::ConstTile flowfieldTile = getFlowfield()->getTile( tilePos.x, tilePos.y );
 
-			if( !flowfieldTile->isGoal() )
+			if( !m_flowfield->isTileFinal( flowfieldTile ) )
 			{
-				CardinalDirection bestAdjacency = flowfieldTile->getBestAdjacency();
-				Map::Tile adjacent = mapTile.getAdjacentTile( bestAdjacency );
+				// The way to the goal is blocked, so hold position until the flowfield reaches this tile.
+				toGoal = Vector::ZERO;
+			}
+			else
+			{
+				// Get the best adjacency from this location.
+				if( !flowfieldTile->isGoal() )
+				{
+					CardinalDirection bestAdjacency = flowfieldTile->getBestAdjacency();
+					Map::Tile adjacent = mapTile.getAdjacentTile( bestAdjacency );
 
-				// Move toward the adjacent tile.
-				Point adjacentPos = m_world->tileToWorldCoords( adjacent.getPosition() );
-				toGoal = ( adjacentPos - m_origin );
+					// Move toward the adjacent tile.
+					Point adjacentPos = m_world->tileToWorldCoords( adjacent.getPosition() );
+					toGoal = ( adjacentPos - m_origin );
+				}
 			}
 		}
 
@@ -122,6 +147,12 @@ namespace atc
 
 			// Set the orientation of the Formation.
 			m_facingAngle = Angle( Direction( directionToGoal ) );
+
+			if( displacement >= distanceToGoal )
+			{
+				// Settle into the footprint the Flowfield led the Units to.
+				m_facingAngle = m_arrivalFacingAngle;
+			}
 		}
 
 		if( m_wasModified )
@@ -171,6 +202,7 @@ namespace atc
 	}
 
 
+#ifndef ATC_HEADLESS
 	void Formation::draw( Renderer* renderer )
 	{
 		// Draw from the center of the Formation.
@@ -209,6 +241,7 @@ namespace atc
 		renderer->drawCircle( CENTER_OF_MASS_DRAW_RADIUS, CENTER_OF_MASS_DRAW_SUBDIVISIONS );
 		renderer->popTransform();
 	}
+#endif
 
 
 	void Formation::addUnit( Unit* unit )
@@ -328,6 +361,18 @@ namespace atc
 	}
 
 
+	Point Formation::getSlotDestination( int index ) const
+	{
+		requires( isValidSlotIndex( index ) );
+
+		// Place the slot around the destination, facing the way the footprint the Flowfield leads to was laid out.
+		const Slot& slot = m_slots[ index ];
+		Direction facing( m_arrivalFacingAngle );
+		Direction perpendicular = facing.getPerpendicular();
+		return ( m_destination + ( slot.offset.x * perpendicular ) + ( slot.offset.y * facing ) );
+	}
+
+
 	Point Formation::getRelativePosition( const Point& worldPosition ) const
 	{
 		// Get the displacement from the origin point of the Formation to the position.
@@ -419,6 +464,9 @@ namespace atc
 			// Recalculate all slots for this Formation.
 			m_behavior->recalculate();
 		}
+
+		// The slots may cover different tiles at the destination now.
+		updateFlowfield();
 	}
 
 
@@ -433,6 +481,88 @@ namespace atc
 	}
 
 
+	void Formation::updateFlowfield()
+	{
+		Map* map = m_world->getMap();
+		Map::TileVector goalPosition = m_world->worldToTileCoords( m_destination );
+		std::vector< Map::TileVector > goalRegion;
+
+		for( int i = 0; i < (int) m_slots.size(); ++i )
+		{
+			// Find the tiles the slots will cover at the destination. Only those in view of the destination are
+			// used, so a Unit that reaches one can always carry on to the destination if its own slot is out of view.
+			// (Slots in an area cut off from the destination are skipped without tracing, so the Flowfield never floods it)
+			Map::TileVector position = m_world->worldToTileCoords( getSlotDestination( i ) );
+
+			if( map->contains( position ) && std::find( goalRegion.begin(), goalRegion.end(), position ) == goalRegion.end() &&
+				( !map->contains( goalPosition ) || map->isReachable( position, goalPosition ) ) &&
+				m_world->traceIsPassable( m_destination, m_world->tileToWorldCoords( position ), Unit::TRACE_RADIUS ) )
+			{
+				goalRegion.push_back( position );
+			}
+		}
+
+		std::vector< size_t > goalRegionIndices;
+		goalRegionIndices.reserve( goalRegion.size() );
+
+		for( const Map::TileVector& position : goalRegion )
+		{
+			goalRegionIndices.push_back( map->getTileIndex( position ) );
+		}
+
+		std::sort( goalRegionIndices.begin(), goalRegionIndices.end() );
+		bool isCovered = ( hasFlowfield() && std::includes( m_flowfieldGoalRegion.begin(), m_flowfieldGoalRegion.end(), goalRegionIndices.begin(), goalRegionIndices.end() ) );
+
+		if( isCovered )
+		{
+			// Units that left only free up slots inside the footprint the Flowfield already leads to, so keep it
+			// rather than trading a finished Flowfield for one that still has to be built.
+			return;
+		}
+
+		// Share the flowfield toward the whole footprint, so each Unit is led to the tiles around its own slot instead
+		// of every Unit crowding onto the destination tile. If no other Formation is using one, the Map builds it in
+		// the background, so giving an order never stalls the frame.
+		Flowfield* flowfield = map->acquireFlowfield( goalPosition, goalRegion );
+
+		if( hasFlowfield() )
+		{
+			// Let go of the old Flowfield only now, in case it's the same one.
+			map->releaseFlowfield( m_flowfield );
+		}
+
+		if( flowfield != m_flowfield )
+		{
+			m_flowfield = flowfield;
+			m_hasLoadedFlowfieldRoute = false;
+		}
+
+		m_flowfieldGoalRegion = goalRegionIndices;
+	}
+
+
+	void Formation::loadFlowfieldSectors()
+	{
+		Map::TileVector originPosition = m_world->worldToTileCoords( m_origin );
+
+		if( !m_hasLoadedFlowfieldRoute )
+		{
+			// Load every sector between the Formation and its goal up front.
+			m_flowfield->loadSectorsAlongRoute( Flowfield::TileVector( originPosition.x, originPosition.y ) );
+			m_hasLoadedFlowfieldRoute = true;
+		}
+
+		// Units can be pushed off the route, so also load the sectors they are in now.
+		m_flowfield->loadSectorAt( Flowfield::TileVector( originPosition.x, originPosition.y ) );
+
+		for( size_t i = 0; i < m_units.getUnitCount(); ++i )
+		{
+			Map::TileVector unitPosition = m_world->worldToTileCoords( m_units.getUnitByIndex( (int) i )->getPosition() );
+			m_flowfield->loadSectorAt( Flowfield::TileVector( unitPosition.x, unitPosition.y ) );
+		}
+	}
+
+
 	void Formation::assignUnitToSlot( Unit* unit, int index )
 	{
 		requires( unit );
@@ -39,8 +39,8 @@ namespace atc
 		if( unitCount > 0 )
 		{
 			// If there is at least one unit in the formation, determine how many columns to form.
-			m_columns = (int) std::ceilf( std::sqrt( (float) unitCount ) );
-			m_rows = (int) std::ceilf( (float) unitCount / m_columns );
+			m_columns = (int) ceilf( std::sqrt( (float) unitCount ) );
+			m_rows = (int) ceilf( (float) unitCount / m_columns );
 
 			// Set the assignment distance based on the size of the Formation.
 			setAssignUnitToSlotDistance( sqrtf( ( m_rows * m_rows ) + ( m_columns * m_columns ) ) + ASSIGN_UNIT_TO_SLOT_DISTANCE_PADDING );
@@ -4,40 +4,150 @@
 
 namespace atc
 {
+	// ------------------------------ MapTile ------------------------------
+
+	const unsigned int MapTile::MIN_COST;
+	const unsigned int MapTile::MAX_COST;
+
+
 	// ------------------------------ Map ------------------------------
 
+	const size_t Map::FLOWFIELD_SLICE_TILE_COUNT;
+	const float Map::CONGESTION_UPDATE_INTERVAL = 0.25f;
+	const char* Map::FLOWFIELD_FILE_EXTENSION = ".flowfield";
+	const unsigned int Map::NO_COMPONENT;
+	const int Map::MAX_CLEARANCE;
+	const int Map::MAX_NEAREST_REACHABLE_RADIUS;
+
+
 	Map::Map() :
-		m_nextFlowfieldIndex( 0 ),
-		m_nextPathfindIndex( 0 )
-	{
-		init();
-	}
+		m_nextPathfindIndex( 0 ),
+		m_flowfieldTileBudget( 0 ),
+		m_flowfieldTimeBudget( 0.0 ),
+		m_sectorGraph( new SectorGraph() ),
+		m_isSectorGraphValid( false ),
+		m_hasWeightedTiles( false ),
+		m_isWeightingValid( false ),
+		m_crowdDensity( new CrowdDensity( this ) ),
+		m_isCrowdDensityEnabled( false ),
+		m_timeSinceCongestionUpdate( 0.0 ),
+		m_areOctileFlowfieldsEnabled( false ),
+		m_contentHash( 0 ),
+		m_isContentHashValid( false ),
+		m_areVectorFieldsEnabled( false ),
+		m_areComponentsValid( false ),
+		m_areClearancesValid( false )
+	{ }
 
 
 	Map::Map( unsigned int width, unsigned int height, const MapTile& fillTile ) :
 		Grid( width, height, fillTile ),
-		m_nextFlowfieldIndex( 0 )
+		m_nextPathfindIndex( 0 ),
+		m_flowfieldTileBudget( 0 ),
+		m_flowfieldTimeBudget( 0.0 ),
+		m_sectorGraph( new SectorGraph() ),
+		m_isSectorGraphValid( false ),
+		m_hasWeightedTiles( false ),
+		m_isWeightingValid( false ),
+		m_crowdDensity( new CrowdDensity( this ) ),
+		m_isCrowdDensityEnabled( false ),
+		m_timeSinceCongestionUpdate( 0.0 ),
+		m_areOctileFlowfieldsEnabled( false ),
+		m_contentHash( 0 ),
+		m_isContentHashValid( false ),
+		m_areVectorFieldsEnabled( false ),
+		m_areComponentsValid( false ),
+		m_areClearancesValid( false )
 	{
 		resize( width, height );
-		init();
+		clear( fillTile );
 	}
 
 
-	Map::~Map() { }
+	Map::~Map()
+	{
+		// Stop the worker thread before freeing the Flowfields it might be using.
+		m_flowfieldWorker.stop();
+
+		for( Flowfield* flowfield : m_flowfields )
+		{
+			delete flowfield;
+		}
+
+		delete m_sectorGraph;
+		delete m_crowdDensity;
+	}
 
 
-	void Map::init()
+	void Map::resize( size_t width, size_t height )
 	{
-		for( int i = 0; i < MAX_FLOWFIELDS; ++i )
+		// Don't free the tiles out from under the flowfield worker.
+		waitForFlowfields();
+
+		Grid::resize( width, height );
+
+		// Unused flowfields were built for the old tiles, so they can't be handed out again.
+		clearUnusedFlowfields();
+
+		for( Flowfield* flowfield : m_flowfields )
 		{
-			// Initialize all flowfield map pointers.
-			m_flowfields[ i ].m_map = this;
+			// Flowfields still in use were built for the old size too. Throw their planes away and size them to the
+			// Map, so they're allocated to fit (and cleared in full) when they're next recalculated.
+			flowfield->discard();
+			flowfield->m_width = width;
+			flowfield->m_height = height;
 		}
+
+		// Shared flowfields were keyed by the indices of tiles in the old rows, so no order can find them now.
+		// (Those still in use are destroyed once they're released)
+		m_sharedFlowfieldsByGoal.clear();
+	}
+
+
+	void Map::clear( const MapTile& fillTile )
+	{
+		// Don't change the tiles out from under the flowfield worker.
+		waitForFlowfields();
+
+		Grid::clear( fillTile );
+		m_pendingTileChanges.clear();
+		m_isSectorGraphValid = false;
+		m_isWeightingValid = false;
+		m_isContentHashValid = false;
+		m_areComponentsValid = false;
+		m_areClearancesValid = false;
+		m_crowdDensity->clear();
+
+		// Unused flowfields were built for the old tiles, so they can't be handed out again.
+		clearUnusedFlowfields();
 	}
 
 
 	void Map::update( double elapsedTime )
 	{
+		// Apply any tiles that were changed since the last frame.
+		applyTileChanges();
+
+		if( !m_areClearancesValid && m_flowfieldWorker.isIdle() )
+		{
+			// Find the clearances of tiles that were set directly (e.g. by a generator) while the worker can't be reading them.
+			findClearances();
+		}
+
+		// Catch up with the crowds every so often, rather than repairing flowfields every frame.
+		m_timeSinceCongestionUpdate += elapsedTime;
+
+		if( m_timeSinceCongestionUpdate >= CONGESTION_UPDATE_INTERVAL && applyCongestionChanges() )
+		{
+			m_timeSinceCongestionUpdate = 0.0;
+		}
+
+		if( isBuildingFlowfieldsInSlices() )
+		{
+			// Carry on building flowfields, up to the budget for this frame.
+			buildFlowfieldSlices( m_flowfieldTileBudget, m_flowfieldTimeBudget );
+		}
+
 		// Determine how many paths to handle this frame.
 		size_t pathfindCount = std::min( m_pathfindRequestsByIndex.size(), (size_t) MAX_PATHFINDS_PER_FRAME );
 
@@ -49,6 +159,21 @@ namespace atc
 	}
 
 
+	void Map::setTilePassable( const TileVector& position, bool isPassable )
+	{
+		requires( contains( position ) );
+
+		// Wait until the next update to change the tile, since the flowfield worker may be reading it now.
+		m_pendingTileChanges.push_back( TileChange( position, isPassable ) );
+	}
+
+
+	bool Map::hasPendingTileChanges() const
+	{
+		return !m_pendingTileChanges.empty();
+	}
+
+
 	int Map::requestPathForUnit( Unit* unit, const Point& destination )
 	{
 		requires( unit );
@@ -69,6 +194,205 @@ namespace atc
 	}
 
 
+	void Map::applyTileChanges()
+	{
+		if( m_pendingTileChanges.empty() || !m_flowfieldWorker.isIdle() )
+		{
+			// Nothing has changed, or the worker is still reading the tiles. Try again next frame.
+			return;
+		}
+
+		std::vector< Flowfield::TileVector > changedPositions;
+
+		for( const TileChange& change : m_pendingTileChanges )
+		{
+			Tile tile = getTile( change.position );
+
+			if( tile->isPassable() != change.isPassable )
+			{
+				tile->setPassable( change.isPassable );
+				changedPositions.push_back( Flowfield::TileVector( change.position.x, change.position.y ) );
+
+				if( m_areComponentsValid )
+				{
+					// Join (or split) the areas on either side of the tile.
+					updateComponents( change.position );
+				}
+
+				if( m_areClearancesValid )
+				{
+					updateClearances( change.position );
+				}
+			}
+		}
+
+		m_pendingTileChanges.clear();
+
+		if( changedPositions.empty() )
+		{
+			return;
+		}
+
+		// The portals between sectors may have changed, and tiles that cost more may have become passable.
+		m_isSectorGraphValid = false;
+		m_isWeightingValid = false;
+		m_isContentHashValid = false;
+		m_crowdDensity->invalidatePassableTileCounts();
+
+		for( Flowfield* flowfield : m_slicedFlowfields )
+		{
+			// Flowfields that are part way through being built have read the old tiles, so start them over.
+			flowfield->setStatus( Flowfield::STATUS_QUEUED );
+		}
+
+		for( Flowfield* flowfield : m_flowfields )
+		{
+			if( !flowfield->isReady() )
+			{
+				// This flowfield was never built, so there is nothing to repair.
+				continue;
+			}
+
+			if( flowfield->isCompressed() )
+			{
+				// Nothing is using this flowfield, so rather than expand it to repair it, build it again if it's used again.
+				flowfield->discard();
+			}
+			else if( flowfield->isHierarchical() )
+			{
+				// Rebuild hierarchical flowfields in the background (along with the SectorGraph).
+				flowfield->recalculateAsync();
+			}
+			else
+			{
+				// Otherwise, only update the tiles whose distances to the goal changed.
+				flowfield->repair( changedPositions );
+			}
+		}
+	}
+
+
+	bool Map::applyCongestionChanges()
+	{
+		if( !m_flowfieldWorker.isIdle() || !m_slicedFlowfields.empty() )
+		{
+			// Flowfields are still being built from the current costs. Try again next frame.
+			return false;
+		}
+
+		std::vector< Flowfield::TileVector > changedPositions;
+		std::vector< size_t > changedSectors;
+
+		for( size_t cell = 0; cell < m_crowdDensity->getCellCount(); ++cell )
+		{
+			// Every tile in a cell has the same congestion cost, so the first one says whether the cell has changed.
+			unsigned int congestionCost = ( m_isCrowdDensityEnabled ? m_crowdDensity->getCongestionCost( cell ) : 0 );
+			TileVector origin = m_crowdDensity->getCellOrigin( cell );
+
+			if( getTile( origin )->getCongestionCost() == congestionCost )
+			{
+				continue;
+			}
+
+			TileOffset right = std::min< TileOffset >( origin.x + CrowdDensity::CELL_SIZE, (TileOffset) m_width );
+			TileOffset top = std::min< TileOffset >( origin.y + CrowdDensity::CELL_SIZE, (TileOffset) m_height );
+
+			for( TileOffset y = origin.y; y < top; ++y )
+			{
+				for( TileOffset x = origin.x; x < right; ++x )
+				{
+					Tile tile = getTile( x, y );
+					tile->setCongestionCost( congestionCost );
+
+					if( tile->isPassable() )
+					{
+						changedPositions.push_back( Flowfield::TileVector( x, y ) );
+					}
+				}
+			}
+
+			if( m_isSectorGraphValid )
+			{
+				changedSectors.push_back( m_sectorGraph->getSectorIndex( origin ) );
+			}
+		}
+
+		if( changedPositions.empty() )
+		{
+			return true;
+		}
+
+		// The SectorGraph is left as it is. Crowds come and go too quickly to rebuild it for them, so hierarchical
+		// flowfields only steer around congestion within the sectors they have loaded.
+		std::sort( changedSectors.begin(), changedSectors.end() );
+		changedSectors.erase( std::unique( changedSectors.begin(), changedSectors.end() ), changedSectors.end() );
+		m_isWeightingValid = false;
+
+		for( Flowfield* flowfield : m_flowfields )
+		{
+			if( !flowfield->isReady() )
+			{
+				continue;
+			}
+
+			if( flowfield->isCompressed() )
+			{
+				flowfield->discard();
+			}
+			else if( flowfield->isHierarchical() )
+			{
+				for( size_t sector : changedSectors )
+				{
+					flowfield->reloadSector( sector );
+				}
+			}
+			else
+			{
+				// Update the distances that the new costs changed.
+				flowfield->repair( changedPositions );
+			}
+		}
+
+		return true;
+	}
+
+
+	void Map::buildFlowfieldSlices( size_t maxTileCount, double maxSeconds )
+	{
+		typedef std::chrono::steady_clock Clock;
+		typedef std::chrono::duration< double > Seconds;
+
+		// A budget of 0 means no limit.
+		Clock::time_point startTime = Clock::now();
+		size_t remainingTileCount = ( maxTileCount > 0 ? maxTileCount : std::numeric_limits< size_t >::max() );
+		bool hasTimeLeft = true;
+
+		while( !m_slicedFlowfields.empty() && remainingTileCount > 0 && hasTimeLeft )
+		{
+			Flowfield* flowfield = m_slicedFlowfields.front();
+
+			if( flowfield->getStatus() == Flowfield::STATUS_QUEUED )
+			{
+				// Start (or start over) building the oldest flowfield.
+				flowfield->beginRecalculation();
+			}
+
+			// Expand a small slice of tiles at a time when there is a time budget, so the clock can be checked in between.
+			size_t sliceTileCount = ( maxSeconds > 0.0 ? std::min( remainingTileCount, FLOWFIELD_SLICE_TILE_COUNT ) : remainingTileCount );
+			size_t tilesExpanded = flowfield->getStatistics().tilesExpanded;
+
+			if( flowfield->continueRecalculation( sliceTileCount ) )
+			{
+				// It's finished, so move on to the next one.
+				m_slicedFlowfields.pop_front();
+			}
+
+			remainingTileCount -= std::min( remainingTileCount, flowfield->getStatistics().tilesExpanded - tilesExpanded );
+			hasTimeLeft = ( maxSeconds <= 0.0 || Seconds( Clock::now() - startTime ).count() < maxSeconds );
+		}
+	}
+
+
 	void Map::findPath()
 	{
 		if( !m_pathfindRequestsByIndex.empty() )
@@ -86,22 +410,32 @@ namespace atc
 			World* world = request.unit->getWorld();
 			Map::Tile destinationTile = world->getMapTileAtPosition( request.destination );
 
-			if( destinationTile.isValid() && destinationTile->isPassable() )
+			// Don't search for a way to a destination that's cut off from the Unit.
+			if( destinationTile.isValid() && destinationTile->isPassable() &&
+				isReachable( request.unit->getCurrentTile().getPosition(), destinationTile.getPosition() ) )
 			{
 				// Add the Unit's current tile to the open list, with a cost of zero and a direction of none.
 				Map::Tile startingTile = request.unit->getCurrentTile();
-				startingTile->setLastPathfindCost( 0.0f );
+				startingTile->setLastPathfindCost( 0 );
 				startingTile->setLastPathfindDirection( CARDINAL_DIRECTION_NONE );
 
+				// Open tiles are handled by their index, so a cheaper way to an open tile just lowers its key.
+				m_openList.clear();
+
+				if( m_openList.getHandleCount() != ( m_width * m_height ) )
+				{
+					m_openList.setHandleCount( m_width * m_height );
+				}
+
 				startingTile->open( request.index );
-				m_openList.insert( 0.0f, startingTile );
+				m_openList.insert( getOpenListKey( 0, Map::TileVector::getManhattanDistance( startingTile.getPosition(), destinationTile.getPosition() ) ), getTileIndex( startingTile.getPosition() ) );
 
 				bool pathWasFound = false;
 
 				while( pathWasFound == false && !m_openList.isEmpty() )
 				{
 					// Pop the first open tile off the open list.
-					Map::Tile currentTile = m_openList.popMinElement();
+					Map::Tile currentTile = getTile( getTilePosition( m_openList.popMinElement() ) );
 
 					// Flag the tile as closed.
 					currentTile->close( request.index );
@@ -138,34 +472,26 @@ namespace atc
 							if( adjacentTile.isValid() && !adjacentTile->isClosed( request.index ) && adjacentTile->isPassable() )
 							{
 								// If the tile is passable, calculate the cost of each adjacent tile.
-								float distanceToGoal = (float) Map::TileVector::getManhattanDistance( adjacentTile.getPosition(), destinationTile.getPosition() );
-								float costToEnterTile = ( currentTile->getLastPathfindCost() + 1.0f ); // TODO: Support variable entry costs, for collision avoidance.
-								float totalCost = ( distanceToGoal + costToEnterTile );
-
-								bool tileDataNeedsUpdate = false;
-
-								if( !adjacentTile->isOpen( request.index ) )
-								{
-									// Open the tile and add it to the open list.
-									adjacentTile->open( request.index );
-									m_openList.insert( totalCost, adjacentTile );
+								unsigned int costToEnterTile = ( currentTile->getLastPathfindCost() + adjacentTile->getCost() );
 
-									// Update the tile data.
-									tileDataNeedsUpdate = true;
-								}
-								else if( totalCost < adjacentTile->getLastPathfindCost() )
+								if( !adjacentTile->isOpen( request.index ) || costToEnterTile < adjacentTile->getLastPathfindCost() )
 								{
-									// If the tile is already open and a better cost was found, update the existing tile on the open list.
-									m_openList.update( totalCost, adjacentTile );
+									// Open the tile and add it to the open list (or move it up, if a cheaper way to it was found).
+									unsigned int distanceToGoal = Map::TileVector::getManhattanDistance( adjacentTile.getPosition(), destinationTile.getPosition() );
+									size_t adjacentTileIndex = getTileIndex( adjacentTile.getPosition() );
 
-									// Update the tile data.
-									tileDataNeedsUpdate = true;
-								}
+									if( m_openList.contains( adjacentTileIndex ) )
+									{
+										m_openList.update( getOpenListKey( costToEnterTile, distanceToGoal ), adjacentTileIndex );
+									}
+									else
+									{
+										adjacentTile->open( request.index );
+										m_openList.insert( getOpenListKey( costToEnterTile, distanceToGoal ), adjacentTileIndex );
+									}
 
-								if( tileDataNeedsUpdate )
-								{
-									// If the tile cost to be updated, update it.
-									adjacentTile->setLastPathfindCost( totalCost );
+									// Update the tile cost.
+									adjacentTile->setLastPathfindCost( costToEnterTile );
 
 									// Keep track of the tile from which we came.
 									CardinalDirection directionToPreviousTile = getOppositeDirection( direction );
@@ -183,25 +509,62 @@ namespace atc
 	}
 
 
-	Flowfield* Map::createFlowfield()
+	void Map::findComponents()
 	{
-		requires( m_nextFlowfieldIndex < MAX_FLOWFIELDS );
+		// Label every passable tile by flooding each area from the first of its tiles found.
+		m_componentsByTile.assign( m_width * m_height, NO_COMPONENT );
+		m_componentSizes.assign( 1, 0 );
+		m_unusedComponents.clear();
 
-		// Get the next available flowfield and initialize it.
-		Flowfield* result = &m_flowfields[ m_nextFlowfieldIndex ];
-		result->reserve();
+		for( TileOffset y = 0; y < (TileOffset) m_height; ++y )
+		{
+			for( TileOffset x = 0; x < (TileOffset) m_width; ++x )
+			{
+				TileVector position( x, y );
 
-		// Resize the flowfield to the same size as the map.
-		result->resize( m_width, m_height );
+				if( m_componentsByTile[ getTileIndex( position ) ] == NO_COMPONENT && getTile( position )->isPassable() )
+				{
+					unsigned int component = createComponent();
+					m_componentSizes[ component ] = fillComponent( position, component );
+				}
+			}
+		}
 
-		for( ++m_nextFlowfieldIndex; m_nextFlowfieldIndex < MAX_FLOWFIELDS; ++m_nextFlowfieldIndex )
+		m_areComponentsValid = true;
+	}
+
+
+	unsigned int Map::getComponent( const TileVector& position )
+	{
+		requires( contains( position ) );
+
+		if( !m_areComponentsValid )
+		{
+			// Label the tiles, since they were loaded (or cleared) since they were last labeled.
+			findComponents();
+		}
+
+		return m_componentsByTile[ getTileIndex( position ) ];
+	}
+
+
+	bool Map::isReachable( const TileVector& start, const TileVector& goal )
+	{
+		requires( contains( start ) );
+		requires( contains( goal ) );
+
+		unsigned int goalComponent = getComponent( goal );
+		bool result = ( goalComponent != NO_COMPONENT && getComponent( start ) == goalComponent );
+
+		if( !result && goalComponent != NO_COMPONENT && getComponent( start ) == NO_COMPONENT )
 		{
-			// Find the next free flowfield after this one.
-			Flowfield* currentFlowfield = &m_flowfields[ m_nextFlowfieldIndex ];
+			// A Unit that was pushed onto a wall can still step off it onto any of its neighbors.
+			ConstTile startTile = getTile( start );
 
-			if( currentFlowfield->isAvailable() )
+			for( CardinalDirection direction : { CARDINAL_DIRECTION_EAST, CARDINAL_DIRECTION_NORTH, CARDINAL_DIRECTION_WEST, CARDINAL_DIRECTION_SOUTH } )
 			{
-				break;
+				ConstTile adjacentTile = startTile.getAdjacentTile( direction );
+				result = ( result || ( adjacentTile.isValid() && m_componentsByTile[ getTileIndex( adjacentTile.getPosition() ) ] == goalComponent ) );
 			}
 		}
 
@@ -209,19 +572,771 @@ namespace atc
 	}
 
 
-	void Map::destroyFlowfield( Flowfield* flowfield )
+	Map::TileVector Map::findNearestReachableTile( const TileVector& start, const TileVector& goal )
 	{
-		// Make sure the flowfield provided is actually part of the Map.
-		ptrdiff_t flowfieldIndex = ( flowfield - m_flowfields );
-		requires( flowfieldIndex >= 0 && flowfieldIndex < MAX_FLOWFIELDS );
+		requires( contains( start ) );
+		requires( contains( goal ) );
+
+		TileVector result = goal;
+
+		if( !isReachable( start, goal ) )
+		{
+			// Search squares of tiles around the goal, each one wider than the last. The nearest reachable tile on the
+			// first square with one may be beaten by one on a later square up to sqrt( 2 ) times as wide, near its corners.
+			// Past MAX_NEAREST_REACHABLE_RADIUS, give up and leave the goal as it is, rather than search the whole map.
+			int maxRadius = std::min( (int) std::max( m_width, m_height ), MAX_NEAREST_REACHABLE_RADIUS );
+			int nearestDistanceSquared = -1;
+
+			for( int radius = 1; radius <= maxRadius && ( nearestDistanceSquared < 0 || radius * radius <= nearestDistanceSquared ); ++radius )
+			{
+				for( int offsetY = -radius; offsetY <= radius; ++offsetY )
+				{
+					// Only visit the edges of the square.
+					int step = ( ( offsetY == -radius || offsetY == radius ) ? 1 : ( radius * 2 ) );
+
+					for( int offsetX = -radius; offsetX <= radius; offsetX += step )
+					{
+						TileVector position( (TileOffset) ( goal.x + offsetX ), (TileOffset) ( goal.y + offsetY ) );
+						int distanceSquared = ( ( offsetX * offsetX ) + ( offsetY * offsetY ) );
+
+						if( ( nearestDistanceSquared < 0 || distanceSquared < nearestDistanceSquared ) &&
+							contains( position ) && isReachable( start, position ) )
+						{
+							result = position;
+							nearestDistanceSquared = distanceSquared;
+						}
+					}
+				}
+			}
+		}
+
+		return result;
+	}
+
+
+	void Map::updateComponents( const TileVector& position )
+	{
+		size_t index = getTileIndex( position );
+		Tile tile = getTile( position );
+		unsigned int adjacentComponents[ CARDINAL_DIRECTION_COUNT ];
+		size_t adjacentComponentCount = 0;
+
+		for( CardinalDirection direction : { CARDINAL_DIRECTION_EAST, CARDINAL_DIRECTION_NORTH, CARDINAL_DIRECTION_WEST, CARDINAL_DIRECTION_SOUTH } )
+		{
+			// Find the areas next to the tile, before it changes them.
+			Tile adjacentTile = tile.getAdjacentTile( direction );
+
+			if( adjacentTile.isValid() )
+			{
+				unsigned int component = m_componentsByTile[ getTileIndex( adjacentTile.getPosition() ) ];
+
+				if( component != NO_COMPONENT && std::find( adjacentComponents, adjacentComponents + adjacentComponentCount, component ) == adjacentComponents + adjacentComponentCount )
+				{
+					adjacentComponents[ adjacentComponentCount ] = component;
+					++adjacentComponentCount;
+				}
+			}
+		}
+
+		if( tile->isPassable() )
+		{
+			// The tile joins the areas next to it into whichever one is largest, or starts a new one on its own.
+			unsigned int largestComponent = NO_COMPONENT;
+
+			for( size_t i = 0; i < adjacentComponentCount; ++i )
+			{
+				if( largestComponent == NO_COMPONENT || m_componentSizes[ adjacentComponents[ i ] ] > m_componentSizes[ largestComponent ] )
+				{
+					largestComponent = adjacentComponents[ i ];
+				}
+			}
+
+			if( largestComponent == NO_COMPONENT )
+			{
+				largestComponent = createComponent();
+			}
+
+			// Relabel the smaller areas, which are all reached through the tile.
+			m_componentSizes[ largestComponent ] += fillComponent( position, largestComponent );
+
+			for( size_t i = 0; i < adjacentComponentCount; ++i )
+			{
+				if( adjacentComponents[ i ] != largestComponent )
+				{
+					promises( m_componentSizes[ adjacentComponents[ i ] ] == 0 );
+					m_unusedComponents.push_back( adjacentComponents[ i ] );
+				}
+			}
+		}
+		else
+		{
+			unsigned int oldComponent = m_componentsByTile[ index ];
+			m_componentsByTile[ index ] = NO_COMPONENT;
+			--m_componentSizes[ oldComponent ];
 
-		// Destroy the flowfield.
-		flowfield->release();
+			if( m_componentSizes[ oldComponent ] == 0 )
+			{
+				m_unusedComponents.push_back( oldComponent );
+			}
+			else if( mightSplitComponent( position ) )
+			{
+				// The tile may have been the only way between its neighbors, so label the area reached from each of
+				// them again. Neighbors that are still connected take the label of the first of them.
+				for( CardinalDirection direction : { CARDINAL_DIRECTION_EAST, CARDINAL_DIRECTION_NORTH, CARDINAL_DIRECTION_WEST, CARDINAL_DIRECTION_SOUTH } )
+				{
+					Tile adjacentTile = tile.getAdjacentTile( direction );
+
+					if( adjacentTile.isValid() && m_componentsByTile[ getTileIndex( adjacentTile.getPosition() ) ] == oldComponent )
+					{
+						unsigned int component = createComponent();
+						m_componentSizes[ component ] = fillComponent( adjacentTile.getPosition(), component );
+					}
+				}
+
+				promises( m_componentSizes[ oldComponent ] == 0 );
+				m_unusedComponents.push_back( oldComponent );
+			}
+		}
+	}
+
+
+	bool Map::mightSplitComponent( const TileVector& position ) const
+	{
+		// Walk the ring of tiles around the (newly impassable) tile. Its passable neighbors are still connected if
+		// they're all on the same unbroken stretch of passable tiles around the ring, since each tile on the ring
+		// shares a side with the next.
+		static const int RING_SIZE = 8;
+		static const int RING_OFFSETS[ RING_SIZE ][ 2 ] = { { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 }, { -1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 } };
+
+		bool isPassable[ RING_SIZE ];
 
-		if( flowfieldIndex < m_nextFlowfieldIndex )
+		for( int i = 0; i < RING_SIZE; ++i )
 		{
-			// Keep track of the next available flowfield index.
-			m_nextFlowfieldIndex = flowfieldIndex;
+			TileVector ringPosition( (TileOffset) ( position.x + RING_OFFSETS[ i ][ 0 ] ), (TileOffset) ( position.y + RING_OFFSETS[ i ][ 1 ] ) );
+			isPassable[ i ] = ( contains( ringPosition ) && getTile( ringPosition )->isPassable() );
 		}
+
+		// Count the stretches of passable tiles that include a neighbor. (The ring's even tiles share a side with the tile)
+		int stretchCount = 0;
+
+		for( int i = 0; i < RING_SIZE; ++i )
+		{
+			bool startsStretch = ( isPassable[ i ] && !isPassable[ ( i + RING_SIZE - 1 ) % RING_SIZE ] );
+
+			if( startsStretch )
+			{
+				bool hasNeighbor = false;
+
+				for( int j = i; isPassable[ j % RING_SIZE ] && j < i + RING_SIZE; ++j )
+				{
+					hasNeighbor = ( hasNeighbor || ( j % 2 ) == 0 );
+				}
+
+				if( hasNeighbor )
+				{
+					++stretchCount;
+				}
+			}
+		}
+
+		return ( stretchCount > 1 );
+	}
+
+
+	size_t Map::fillComponent( const TileVector& start, unsigned int component )
+	{
+		requires( getTile( start )->isPassable() );
+
+		// Label every passable tile connected to the start that isn't labeled yet. Returns how many were labeled.
+		size_t result = 0;
+		m_componentQueue.clear();
+		m_componentQueue.push_back( start );
+
+		if( m_componentsByTile[ getTileIndex( start ) ] != component )
+		{
+			relabelTile( getTileIndex( start ), component );
+			++result;
+		}
+
+		for( size_t i = 0; i < m_componentQueue.size(); ++i )
+		{
+			TileVector position = m_componentQueue[ i ];
+
+			for( CardinalDirection direction : { CARDINAL_DIRECTION_EAST, CARDINAL_DIRECTION_NORTH, CARDINAL_DIRECTION_WEST, CARDINAL_DIRECTION_SOUTH } )
+			{
+				TileVector adjacentPosition = ( position + getDirectionVector( direction ) );
+
+				if( contains( adjacentPosition ) )
+				{
+					size_t adjacentIndex = getTileIndex( adjacentPosition );
+
+					if( m_componentsByTile[ adjacentIndex ] != component && getTileData( adjacentIndex ).isPassable() )
+					{
+						relabelTile( adjacentIndex, component );
+						m_componentQueue.push_back( adjacentPosition );
+						++result;
+					}
+				}
+			}
+		}
+
+		return result;
+	}
+
+
+	void Map::relabelTile( size_t index, unsigned int component )
+	{
+		// Take the tile out of the area it was labeled with before.
+		if( m_componentsByTile[ index ] != NO_COMPONENT )
+		{
+			--m_componentSizes[ m_componentsByTile[ index ] ];
+		}
+
+		m_componentsByTile[ index ] = component;
+	}
+
+
+	unsigned int Map::createComponent()
+	{
+		// Reuse the label of an area that was joined to another (or walled in), if there is one.
+		unsigned int result;
+
+		if( !m_unusedComponents.empty() )
+		{
+			result = m_unusedComponents.back();
+			m_unusedComponents.pop_back();
+		}
+		else
+		{
+			result = (unsigned int) m_componentSizes.size();
+			m_componentSizes.push_back( 0 );
+		}
+
+		return result;
+	}
+
+
+	void Map::findClearances()
+	{
+		// Each tile's square is one wider than the smallest of the squares of the tiles above it, to its right, and
+		// diagonally between, so find them from the top right corner down.
+		m_clearances.assign( m_width * m_height, 0 );
+
+		for( TileOffset y = (TileOffset) m_height - 1; y >= 0; --y )
+		{
+			for( TileOffset x = (TileOffset) m_width - 1; x >= 0; --x )
+			{
+				TileVector position( x, y );
+				findClearance( getTileIndex( position ), position );
+			}
+		}
+
+		m_areClearancesValid = true;
+	}
+
+
+	bool Map::hasClearance( const TileVector& position, int radius ) const
+	{
+		requires( radius >= 0 );
+
+		// Whether every tile within the radius (along either axis) of the tile is on the Map and passable.
+		TileVector offset( (TileOffset) radius, (TileOffset) radius );
+		return isAreaPassable( position - offset, position + offset );
+	}
+
+
+	bool Map::isAreaPassable( const TileVector& minCorner, const TileVector& maxCorner ) const
+	{
+		// Tiles off the edge of the Map aren't passable.
+		bool result = ( contains( minCorner ) && contains( maxCorner ) );
+
+		if( result )
+		{
+			int width = ( maxCorner.x - minCorner.x + 1 );
+			int height = ( maxCorner.y - minCorner.y + 1 );
+			int size = std::min( width, height );
+
+			if( m_areClearancesValid && size <= MAX_CLEARANCE && std::max( width, height ) <= ( size * 2 ) )
+			{
+				// Two squares as wide as the narrower side of the area, in opposite corners, cover all of it.
+				TileVector farCorner( (TileOffset) ( maxCorner.x - size + 1 ), (TileOffset) ( maxCorner.y - size + 1 ) );
+				result = ( m_clearances[ getTileIndex( minCorner ) ] >= size && m_clearances[ getTileIndex( farCorner ) ] >= size );
+			}
+			else
+			{
+				for( TileOffset y = minCorner.y; y <= maxCorner.y && result; ++y )
+				{
+					for( TileOffset x = minCorner.x; x <= maxCorner.x && result; ++x )
+					{
+						result = getTile( x, y )->isPassable();
+					}
+				}
+			}
+		}
+
+		return result;
+	}
+
+
+	void Map::updateClearances( const TileVector& position )
+	{
+		// Only the squares that could reach the tile change, which are those of the tiles up to MAX_CLEARANCE to its
+		// left and below it.
+		TileOffset minX = (TileOffset) std::max( position.x - MAX_CLEARANCE + 1, 0 );
+		TileOffset minY = (TileOffset) std::max( position.y - MAX_CLEARANCE + 1, 0 );
+
+		for( TileOffset y = position.y; y >= minY; --y )
+		{
+			for( TileOffset x = position.x; x >= minX; --x )
+			{
+				TileVector squarePosition( x, y );
+				findClearance( getTileIndex( squarePosition ), squarePosition );
+			}
+		}
+	}
+
+
+	void Map::findClearance( size_t index, const TileVector& position )
+	{
+		unsigned char clearance = 0;
+
+		if( getTile( position )->isPassable() )
+		{
+			// Squares off the edge of the Map are empty.
+			bool hasRight = ( position.x + 1 < (int) m_width );
+			bool hasTop = ( position.y + 1 < (int) m_height );
+			int right = ( hasRight ? m_clearances[ index + 1 ] : 0 );
+			int top = ( hasTop ? m_clearances[ index + m_width ] : 0 );
+			int topRight = ( hasRight && hasTop ? m_clearances[ index + m_width + 1 ] : 0 );
+			clearance = (unsigned char) std::min( std::min( std::min( right, top ), topRight ) + 1, MAX_CLEARANCE );
+		}
+
+		m_clearances[ index ] = clearance;
+	}
+
+
+	Flowfield* Map::createFlowfield()
+	{
+		// Create a private flowfield the same size as the map.
+		Flowfield* result = new Flowfield();
+		result->m_map = this;
+		result->resize( m_width, m_height );
+
+		m_flowfields.push_back( result );
+		return result;
+	}
+
+
+	void Map::destroyFlowfield( Flowfield* flowfield )
+	{
+		// Make sure the flowfield provided is actually part of the Map, and isn't shared.
+		requires( ownsFlowfield( flowfield ) );
+		requires( !flowfield->isShared() );
+
+		// Make sure the worker thread is done with the flowfield, then destroy it.
+		m_flowfieldWorker.cancel( flowfield );
+		m_slicedFlowfields.erase( std::remove( m_slicedFlowfields.begin(), m_slicedFlowfields.end(), flowfield ), m_slicedFlowfields.end() );
+		m_flowfields.erase( std::find( m_flowfields.begin(), m_flowfields.end(), flowfield ) );
+		delete flowfield;
+	}
+
+
+	void Map::submitFlowfield( Flowfield* flowfield )
+	{
+		// Make sure the flowfield provided is actually part of the Map.
+		requires( ownsFlowfield( flowfield ) );
+
+		if( isBuildingFlowfieldsInSlices() )
+		{
+			// Queue the flowfield to be recalculated from scratch over the next few updates.
+			if( std::find( m_slicedFlowfields.begin(), m_slicedFlowfields.end(), flowfield ) == m_slicedFlowfields.end() )
+			{
+				m_slicedFlowfields.push_back( flowfield );
+			}
+
+			flowfield->setStatus( Flowfield::STATUS_QUEUED );
+		}
+		else
+		{
+			// Queue the flowfield to be recalculated on the worker thread.
+			m_flowfieldWorker.submit( flowfield );
+		}
+	}
+
+
+	void Map::waitForFlowfields()
+	{
+		// Block until every submitted flowfield has been published.
+		m_flowfieldWorker.waitUntilIdle();
+		buildFlowfieldSlices( 0, 0.0 );
+	}
+
+
+	void Map::setFlowfieldBuildBudget( size_t maxTilesPerFrame, double maxSecondsPerFrame )
+	{
+		requires( maxSecondsPerFrame >= 0.0 );
+
+		// Finish any flowfields that were submitted the old way.
+		waitForFlowfields();
+
+		m_flowfieldTileBudget = maxTilesPerFrame;
+		m_flowfieldTimeBudget = maxSecondsPerFrame;
+	}
+
+
+	Flowfield* Map::acquireFlowfield( const TileVector& goalPosition, const std::vector< TileVector >& goalRegion )
+	{
+		requires( contains( goalPosition ) );
+
+		// On large maps, only build the flowfield in the sectors where it's needed. Those
+		// flowfields only search from the goal tile, so they're shared whatever the region.
+		// So are flowfields baked toward the goal tile, which load faster than any region could be built.
+		bool isHierarchical = ( ( m_width * m_height ) >= HIERARCHICAL_FLOWFIELD_MIN_TILES );
+		std::vector< Flowfield::TileVector > flowfieldGoalRegion;
+
+		if( !isHierarchical && !hasCachedFlowfield( goalPosition ) )
+		{
+			for( const TileVector& position : goalRegion )
+			{
+				flowfieldGoalRegion.push_back( Flowfield::TileVector( position.x, position.y ) );
+			}
+		}
+
+		std::vector< size_t > key = getFlowfieldKey( goalPosition, flowfieldGoalRegion );
+
+		Flowfield* result = nullptr;
+		auto it = m_sharedFlowfieldsByGoal.find( key );
+
+		if( it != m_sharedFlowfieldsByGoal.end() )
+		{
+			// Share the existing flowfield toward this goal.
+			result = it->second;
+
+			if( result->getReferenceCount() == 0 )
+			{
+				// It was unused, so take it off the eviction list and expand it again.
+				m_unusedFlowfields.erase( std::find( m_unusedFlowfields.begin(), m_unusedFlowfields.end(), result ) );
+
+				if( result->isCompressed() )
+				{
+					result->decompress();
+				}
+				else if( result->getStatus() == Flowfield::STATUS_EMPTY )
+				{
+					// The tiles changed while it was compressed, so it was thrown away rather than repaired.
+					result->recalculateAsync();
+				}
+			}
+		}
+		else
+		{
+			// Otherwise, start building a new shared flowfield toward the goal.
+			result = createFlowfield();
+			result->m_isShared = true;
+			result->setGoalTile( result->getTile( goalPosition.x, goalPosition.y ) );
+			result->setGoalRegion( flowfieldGoalRegion );
+
+			// Find where Units (and Formations) can see the goal, so they can head straight for it without tracing.
+			result->setLineOfSightRadius( Unit::TRACE_RADIUS );
+			result->setVectorFieldEnabled( m_areVectorFieldsEnabled );
+
+			// Load the flowfield if it was baked ahead of time. Otherwise, build it.
+			if( !loadCachedFlowfield( result ) )
+			{
+				result->setHierarchical( isHierarchical );
+				result->setOctile( m_areOctileFlowfieldsEnabled && !isHierarchical );
+				result->recalculateAsync();
+			}
+
+			m_sharedFlowfieldsByGoal[ key ] = result;
+		}
+
+		result->addReference();
+		return result;
+	}
+
+
+	void Map::releaseFlowfield( Flowfield* flowfield )
+	{
+		requires( ownsFlowfield( flowfield ) );
+		requires( flowfield->isShared() );
+
+		flowfield->removeReference();
+
+		if( flowfield->getReferenceCount() == 0 )
+		{
+			// Keep the unused flowfield around in case another order heads to the same goal. Compress it
+			// (unless it's still being built), so many more can be kept than would fit at full size.
+			m_unusedFlowfields.push_back( flowfield );
+
+			if( flowfield->isReady() && !flowfield->isHierarchical() )
+			{
+				flowfield->compress();
+			}
+
+			if( m_unusedFlowfields.size() > MAX_UNUSED_FLOWFIELDS )
+			{
+				// Evict the least recently used flowfield.
+				Flowfield* flowfieldToEvict = m_unusedFlowfields.front();
+				m_unusedFlowfields.pop_front();
+				evictFlowfield( flowfieldToEvict );
+			}
+		}
+	}
+
+
+	void Map::clearUnusedFlowfields()
+	{
+		// Evict every shared flowfield that nothing refers to.
+		for( Flowfield* flowfield : m_unusedFlowfields )
+		{
+			evictFlowfield( flowfield );
+		}
+
+		m_unusedFlowfields.clear();
+	}
+
+
+	void Map::evictFlowfield( Flowfield* flowfield )
+	{
+		requires( flowfield->isShared() && flowfield->getReferenceCount() == 0 );
+
+		// Remove the flowfield from the cache, then destroy it. Look it up by value, since the Map may have been
+		// resized since it was shared, and its key may now belong to a flowfield shared after that.
+		auto it = std::find_if( m_sharedFlowfieldsByGoal.begin(), m_sharedFlowfieldsByGoal.end(), [ flowfield ]( const std::pair< const std::vector< size_t >, Flowfield* >& entry )
+		{
+			return ( entry.second == flowfield );
+		} );
+
+		if( it != m_sharedFlowfieldsByGoal.end() )
+		{
+			// (Flowfields that were in use when the Map was resized were already taken out)
+			m_sharedFlowfieldsByGoal.erase( it );
+		}
+		flowfield->m_isShared = false;
+		destroyFlowfield( flowfield );
+	}
+
+
+	bool Map::hasCachedFlowfield( const TileVector& goalPosition )
+	{
+		bool result = false;
+
+		// Congestion costs aren't saved, so a baked flowfield would lead Units straight into the crowds.
+		if( !m_flowfieldCacheFolder.empty() && !m_isCrowdDensityEnabled )
+		{
+			FILE* file = fopen( getFlowfieldCachePath( goalPosition, std::vector< Flowfield::TileVector >(), m_areOctileFlowfieldsEnabled ).c_str(), "rb" );
+
+			if( file )
+			{
+				fclose( file );
+				result = true;
+			}
+		}
+
+		return result;
+	}
+
+
+	bool Map::loadCachedFlowfield( Flowfield* flowfield )
+	{
+		requires( ownsFlowfield( flowfield ) );
+
+		bool result = false;
+
+		if( !m_flowfieldCacheFolder.empty() && !m_isCrowdDensityEnabled )
+		{
+			// Baked flowfields are always complete, even on Maps large enough for hierarchical ones.
+			Flowfield::TileVector goalPosition = flowfield->getGoalTile().getPosition();
+			flowfield->setHierarchical( false );
+			flowfield->setOctile( m_areOctileFlowfieldsEnabled );
+			result = flowfield->loadFromFile( getFlowfieldCachePath( TileVector( goalPosition.x, goalPosition.y ), flowfield->getGoalRegion(), m_areOctileFlowfieldsEnabled ) );
+		}
+
+		return result;
+	}
+
+
+	std::string Map::getFlowfieldCachePath( const TileVector& goalPosition, const std::vector< Flowfield::TileVector >& goalRegion, bool isOctile )
+	{
+		requires( contains( goalPosition ) );
+
+		std::vector< size_t > key = getFlowfieldKey( goalPosition, goalRegion );
+
+		// Name the file after the tiles of the Map, so a Map that has been edited never loads a stale flowfield.
+		std::stringstream formatter;
+		formatter << m_flowfieldCacheFolder << std::hex << getContentHash() << std::dec << "-" << goalPosition.x << "-" << goalPosition.y;
+
+		if( key.size() > 1 )
+		{
+			// Tell goal regions apart by a hash of the rest of their tiles.
+			uint64_t regionHash = 14695981039346656037ULL;
+
+			for( size_t i = 1; i < key.size(); ++i )
+			{
+				regionHash = ( ( regionHash ^ key[ i ] ) * 1099511628211ULL );
+			}
+
+			formatter << "-r" << std::hex << regionHash << std::dec;
+		}
+
+		if( isOctile )
+		{
+			formatter << "-octile";
+		}
+
+		formatter << FLOWFIELD_FILE_EXTENSION;
+		return formatter.str();
+	}
+
+
+	uint64_t Map::getContentHash()
+	{
+		if( !m_isContentHashValid )
+		{
+			// Hash (with FNV-1a, a value at a time) the size of the Map, and the terrain cost of each tile (or zero for walls).
+			// Congestion costs come and go with the crowds, so they aren't part of the content.
+			uint64_t hash = 14695981039346656037ULL;
+			hash = ( ( hash ^ getWidth() ) * 1099511628211ULL );
+			hash = ( ( hash ^ getHeight() ) * 1099511628211ULL );
+
+			for( size_t i = 0; i < ( getWidth() * getHeight() ); ++i )
+			{
+				const MapTile& tile = getTileData( i );
+				hash = ( ( hash ^ ( tile.isPassable() ? tile.getTerrainCost() : 0 ) ) * 1099511628211ULL );
+			}
+
+			m_contentHash = hash;
+			m_isContentHashValid = true;
+		}
+
+		return m_contentHash;
+	}
+
+
+	std::vector< size_t > Map::getFlowfieldKey( const TileVector& goalPosition, const std::vector< Flowfield::TileVector >& goalRegion ) const
+	{
+		std::vector< size_t > result;
+		result.reserve( goalRegion.size() + 1 );
+
+		for( const Flowfield::TileVector& position : goalRegion )
+		{
+			requires( contains( TileVector( position.x, position.y ) ) );
+			result.push_back( getTileIndex( TileVector( position.x, position.y ) ) );
+		}
+
+		// The order of the goal region doesn't matter, nor does listing the goal tile in it.
+		std::sort( result.begin(), result.end() );
+		result.erase( std::unique( result.begin(), result.end() ), result.end() );
+		result.erase( std::remove( result.begin(), result.end(), getTileIndex( goalPosition ) ), result.end() );
+		result.insert( result.begin(), getTileIndex( goalPosition ) );
+		return result;
+	}
+
+
+	uint64_t Map::getOpenListKey( unsigned int costSoFar, unsigned int distanceToGoal )
+	{
+		// Order open tiles by their cost so far plus the Manhattan distance left, and break ties in favor of the tile
+		// closest to the goal. Otherwise, A* widens out across every tile with the same estimate (which is most of an
+		// open map) before it heads for the goal.
+		uint64_t totalCost = ( (uint64_t) costSoFar + distanceToGoal );
+		return ( ( totalCost << 32 ) | distanceToGoal );
+	}
+
+
+	const SectorGraph* Map::getSectorGraph()
+	{
+		// This is called when hierarchical flowfields are recalculated, usually on the worker thread. The
+		// tiles (and so the SectorGraph) are only ever changed while the worker is idle.
+		if( !m_isSectorGraphValid )
+		{
+			// Rebuild the SectorGraph, since the tiles changed since it was last built.
+			m_sectorGraph->rebuild( this );
+			m_isSectorGraphValid = true;
+		}
+
+		return m_sectorGraph;
+	}
+
+
+	bool Map::hasWeightedTiles()
+	{
+		// Like the SectorGraph, this is checked when flowfields are recalculated, usually on the worker thread.
+		if( !m_isWeightingValid )
+		{
+			m_hasWeightedTiles = false;
+
+			for( size_t i = 0; i < ( m_width * m_height ) && !m_hasWeightedTiles; ++i )
+			{
+				// Look for any passable tile that costs more than the rest.
+				const MapTile& tile = getTileData( i );
+				m_hasWeightedTiles = ( tile.isPassable() && tile.getCost() != MapTile::MIN_COST );
+			}
+
+			m_isWeightingValid = true;
+		}
+
+		// Crowds can make any tile cost more at any time.
+		return ( m_hasWeightedTiles || m_isCrowdDensityEnabled );
+	}
+
+
+	void Map::setCrowdDensityEnabled( bool isEnabled )
+	{
+		// Flowfields being built on the worker check whether the tiles are weighted.
+		waitForFlowfields();
+		m_isCrowdDensityEnabled = isEnabled;
+
+		// Apply (or clear) the congestion costs on the next update.
+		m_timeSinceCongestionUpdate = CONGESTION_UPDATE_INTERVAL;
+	}
+
+
+	void Map::setOctileFlowfieldsEnabled( bool isEnabled )
+	{
+		// Flowfields being built on the worker read which way they step.
+		waitForFlowfields();
+		m_areOctileFlowfieldsEnabled = isEnabled;
+
+		for( auto it = m_sharedFlowfieldsByGoal.begin(); it != m_sharedFlowfieldsByGoal.end(); ++it )
+		{
+			Flowfield* flowfield = it->second;
+
+			if( !flowfield->isHierarchical() && flowfield->isOctile() != isEnabled )
+			{
+				// Rebuild the shared flowfields the new way, so every order toward a goal moves alike. (Unused
+				// ones that were compressed are only built again if they're used again.)
+				flowfield->setOctile( isEnabled );
+
+				if( flowfield->isCompressed() )
+				{
+					flowfield->discard();
+				}
+				else
+				{
+					flowfield->recalculateAsync();
+				}
+			}
+		}
+	}
+
+
+	void Map::setVectorFieldsEnabled( bool isEnabled )
+	{
+		// Flowfields being built on the worker read whether to find their vector fields once they're done.
+		waitForFlowfields();
+		m_areVectorFieldsEnabled = isEnabled;
+
+		for( auto it = m_sharedFlowfieldsByGoal.begin(); it != m_sharedFlowfieldsByGoal.end(); ++it )
+		{
+			// Find (or free) the vector fields of the shared flowfields. Compressed ones find theirs when they're used again.
+			it->second->setVectorFieldEnabled( isEnabled );
+		}
+	}
+
+
+	bool Map::ownsFlowfield( const Flowfield* flowfield ) const
+	{
+		return ( std::find( m_flowfields.begin(), m_flowfields.end(), flowfield ) != m_flowfields.end() );
 	}
 }
\ No newline at end of file
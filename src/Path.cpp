@@ -19,6 +19,7 @@ namespace atc
 	Path::~Path() { }
 
 
+#ifndef ATC_HEADLESS
 	void Path::draw( Renderer* renderer )
 	{
 		if( isValid() )
@@ -40,4 +41,5 @@ namespace atc
 			}
 		}
 	}
+#endif
 }
\ No newline at end of file
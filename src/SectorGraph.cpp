@@ -0,0 +1,235 @@
+#include "common.h"
+#include "SectorGraph.h"
+
+
+namespace atc
+{
+	const int SectorGraph::SECTOR_SIZE;
+	const size_t SectorGraph::SECTOR_TILE_COUNT;
+	const unsigned int SectorGraph::UNREACHABLE;
+
+
+	SectorGraph::SectorGraph() :
+		m_map( nullptr ),
+		m_sectorsWide( 0 ),
+		m_sectorsHigh( 0 )
+	{ }
+
+
+	SectorGraph::~SectorGraph() { }
+
+
+	void SectorGraph::rebuild( const Map* map )
+	{
+		requires( map );
+		m_map = map;
+
+		// Cover the Map with sectors, rounding up at the edges.
+		size_t width = map->getWidth();
+		size_t height = map->getHeight();
+		m_sectorsWide = ( ( width + SECTOR_SIZE - 1 ) / SECTOR_SIZE );
+		m_sectorsHigh = ( ( height + SECTOR_SIZE - 1 ) / SECTOR_SIZE );
+
+		m_portals.clear();
+		m_portalsBySector.assign( getSectorCount(), std::vector< size_t >() );
+
+		for( size_t sectorY = 0; sectorY < m_sectorsHigh; ++sectorY )
+		{
+			for( size_t sectorX = 0; sectorX < m_sectorsWide; ++sectorX )
+			{
+				size_t sector = ( sectorX + ( sectorY * m_sectorsWide ) );
+				TileVector origin = getSectorOrigin( sector );
+				TileVector size = getSectorSize( sector );
+
+				if( sectorX + 1 < m_sectorsWide )
+				{
+					// Find the portals along the east edge of the sector.
+					TileVector firstStart( origin.x + size.x - 1, origin.y );
+					addPortals( firstStart, TileVector( 0, 1 ), TileVector( 1, 0 ), CARDINAL_DIRECTION_EAST, size.y );
+				}
+
+				if( sectorY + 1 < m_sectorsHigh )
+				{
+					// Find the portals along the south edge of the sector.
+					TileVector firstStart( origin.x, origin.y + size.y - 1 );
+					addPortals( firstStart, TileVector( 1, 0 ), TileVector( 0, 1 ), CARDINAL_DIRECTION_SOUTH, size.x );
+				}
+			}
+		}
+
+		m_edgesByNode.assign( getNodeCount(), std::vector< Edge >() );
+
+		for( size_t i = 0; i < m_portals.size(); ++i )
+		{
+			// Crossing a portal takes one step, in either direction. Edges lead away from the goal, so an edge from
+			// one side costs the step back onto that side.
+			const Portal& portal = m_portals[ i ];
+			Edge crossing;
+
+			crossing.node = getNode( i, 1 );
+			crossing.cost = m_map->getTile( portal.getCenter( 0 ) )->getCost();
+			m_edgesByNode[ getNode( i, 0 ) ].push_back( crossing );
+
+			crossing.node = getNode( i, 0 );
+			crossing.cost = m_map->getTile( portal.getCenter( 1 ) )->getCost();
+			m_edgesByNode[ getNode( i, 1 ) ].push_back( crossing );
+		}
+
+		// Share the open list between the searches of every sector.
+		BucketQueue< TileVector > tilesToEvaluate;
+
+		for( size_t sector = 0; sector < getSectorCount(); ++sector )
+		{
+			// Link the portals that can reach each other within each sector.
+			connectSectorPortals( sector, tilesToEvaluate );
+		}
+	}
+
+
+	void SectorGraph::findSectorDistances( size_t sector, const TileVector& source, std::vector< unsigned int >& distances ) const
+	{
+		BucketQueue< TileVector > tilesToEvaluate;
+		findSectorDistances( sector, source, distances, tilesToEvaluate );
+	}
+
+
+	void SectorGraph::findSectorDistances( size_t sector, const TileVector& source, std::vector< unsigned int >& distances, BucketQueue< TileVector >& tilesToEvaluate ) const
+	{
+		requires( sectorContains( sector, source ) );
+
+		distances.assign( SECTOR_TILE_COUNT, UNREACHABLE );
+
+		// Search outward from the source, without leaving the sector. Like a Flowfield, the source itself doesn't need
+		// to be passable, and each tile is keyed by the distance it offers its neighbors (its own distance plus its cost),
+		// so the first tile to reach each neighbor offers it the shortest route.
+		tilesToEvaluate.clear();
+		tilesToEvaluate.setMaxKeySpread( MapTile::MAX_COST );
+		tilesToEvaluate.insert( m_map->getTile( source )->getCost(), source );
+		distances[ getLocalTileIndex( sector, source ) ] = 0;
+
+		while( !tilesToEvaluate.isEmpty() )
+		{
+			unsigned int adjacentDistance = tilesToEvaluate.peekMinKey();
+			TileVector position = tilesToEvaluate.popMinElement();
+			CardinalDirection direction = CARDINAL_DIRECTION_EAST;
+
+			for( size_t i = 0; i < CARDINAL_DIRECTION_COUNT; ++i )
+			{
+				TileVector adjacentPosition = ( position + Map::getDirectionVector( direction ) );
+
+				if( sectorContains( sector, adjacentPosition ) )
+				{
+					unsigned int& distance = distances[ getLocalTileIndex( sector, adjacentPosition ) ];
+
+					if( distance == UNREACHABLE )
+					{
+						Map::ConstTile adjacentTile = m_map->getTile( adjacentPosition );
+
+						if( adjacentTile->isPassable() )
+						{
+							// Open the tile.
+							distance = adjacentDistance;
+							tilesToEvaluate.insert( adjacentDistance + adjacentTile->getCost(), adjacentPosition );
+						}
+					}
+				}
+
+				direction = getCounterClockwiseDirection( direction );
+			}
+		}
+	}
+
+
+	void SectorGraph::addPortals( const TileVector& firstStart, const TileVector& step, const TileVector& across, CardinalDirection crossing, size_t length )
+	{
+		size_t runStart = 0;
+		size_t runLength = 0;
+		unsigned int runCosts = 0;
+
+		for( size_t i = 0; i <= length; ++i )
+		{
+			bool isOpen = false;
+			unsigned int costs = 0;
+
+			if( i < length )
+			{
+				// Check whether both tiles across the border are passable.
+				TileVector position( firstStart.x + (Map::TileOffset) ( step.x * i ), firstStart.y + (Map::TileOffset) ( step.y * i ) );
+				Map::ConstTile tile = m_map->getTile( position );
+				Map::ConstTile acrossTile = m_map->getTile( position + across );
+				isOpen = ( tile->isPassable() && acrossTile->isPassable() );
+				costs = ( ( tile->getCost() << 8 ) | acrossTile->getCost() );
+			}
+
+			if( runLength > 0 && ( !isOpen || costs != runCosts ) )
+			{
+				// Close off the run of open tiles as a portal. Runs are also split wherever the cost of the tiles
+				// changes (e.g. where a road crosses the border), so the center of each portal stands for all of it.
+				TileVector start( firstStart.x + (Map::TileOffset) ( step.x * runStart ), firstStart.y + (Map::TileOffset) ( step.y * runStart ) );
+				addPortal( start, step, across, crossing, runLength );
+				runLength = 0;
+			}
+
+			if( isOpen )
+			{
+				if( runLength == 0 )
+				{
+					runStart = i;
+					runCosts = costs;
+				}
+
+				++runLength;
+			}
+		}
+	}
+
+
+	void SectorGraph::addPortal( const TileVector& start, const TileVector& step, const TileVector& across, CardinalDirection crossing, size_t length )
+	{
+		Portal portal;
+		portal.start[ 0 ] = start;
+		portal.start[ 1 ] = ( start + across );
+		portal.step = step;
+		portal.crossing = crossing;
+		portal.length = length;
+		portal.sectors[ 0 ] = getSectorIndex( portal.start[ 0 ] );
+		portal.sectors[ 1 ] = getSectorIndex( portal.start[ 1 ] );
+
+		size_t portalIndex = m_portals.size();
+		m_portals.push_back( portal );
+		m_portalsBySector[ portal.sectors[ 0 ] ].push_back( portalIndex );
+		m_portalsBySector[ portal.sectors[ 1 ] ].push_back( portalIndex );
+	}
+
+
+	void SectorGraph::connectSectorPortals( size_t sector, BucketQueue< TileVector >& tilesToEvaluate )
+	{
+		const std::vector< size_t >& portals = m_portalsBySector[ sector ];
+		std::vector< unsigned int > distances;
+
+		for( size_t i = 0; i < portals.size(); ++i )
+		{
+			// Measure the distance from the center of this portal to every tile in the sector.
+			size_t side = getSideInSector( portals[ i ], sector );
+			findSectorDistances( sector, m_portals[ portals[ i ] ].getCenter( side ), distances, tilesToEvaluate );
+
+			for( size_t j = 0; j < portals.size(); ++j )
+			{
+				if( i != j )
+				{
+					// Link this portal to each other portal it can reach without leaving the sector.
+					size_t otherSide = getSideInSector( portals[ j ], sector );
+					unsigned int distance = distances[ getLocalTileIndex( sector, m_portals[ portals[ j ] ].getCenter( otherSide ) ) ];
+
+					if( distance != UNREACHABLE )
+					{
+						Edge edge;
+						edge.node = getNode( portals[ j ], otherSide );
+						edge.cost = distance;
+						m_edgesByNode[ getNode( portals[ i ], side ) ].push_back( edge );
+					}
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,105 @@
+#include "common.h"
+#include "SpatialHash.h"
+
+namespace atc
+{
+	SpatialHash::SpatialHash() :
+		m_cellSize( 1.0f ),
+		m_inverseCellSize( 1.0f ),
+		m_bucketMask( 0 )
+	{ }
+
+
+	SpatialHash::~SpatialHash() { }
+
+
+	void SpatialHash::rebuild( const std::vector< Actor* >& actors, float cellSize )
+	{
+		requires( cellSize > 0.0f );
+
+		m_cellSize = cellSize;
+		m_inverseCellSize = ( 1.0f / cellSize );
+
+		// Use about twice as many buckets as Actors (rounded up to a power of two),
+		// so that few unrelated cells share a bucket.
+		size_t bucketCount = 1;
+
+		while( bucketCount < ( actors.size() * 2 ) )
+		{
+			bucketCount <<= 1;
+		}
+
+		m_bucketMask = ( bucketCount - 1 );
+		m_bucketStarts.assign( bucketCount + 1, 0 );
+		m_actorBuckets.resize( actors.size() );
+		m_actorsByBucket.resize( actors.size() );
+
+		for( size_t i = 0; i < actors.size(); ++i )
+		{
+			// Count the number of Actors in each bucket.
+			Point position = actors[ i ]->getPosition();
+			size_t bucket = getBucketIndex( getCellCoordinate( position.x ), getCellCoordinate( position.y ) );
+
+			m_actorBuckets[ i ] = bucket;
+			++m_bucketStarts[ bucket ];
+		}
+
+		for( size_t bucket = 1; bucket <= bucketCount; ++bucket )
+		{
+			// Turn the counts into the end index of each bucket.
+			m_bucketStarts[ bucket ] += m_bucketStarts[ bucket - 1 ];
+		}
+
+		for( size_t i = actors.size(); i-- > 0; )
+		{
+			// Fill each bucket from the back, which leaves each start index pointing at
+			// the front of its bucket and keeps Actors in their original order.
+			size_t index = --m_bucketStarts[ m_actorBuckets[ i ] ];
+			m_actorsByBucket[ index ] = actors[ i ];
+		}
+	}
+
+
+	void SpatialHash::clear()
+	{
+		m_bucketMask = 0;
+		m_bucketStarts.assign( 2, 0 );
+		m_actorBuckets.clear();
+		m_actorsByBucket.clear();
+	}
+
+
+	void SpatialHash::findNearbyActors( const Point& position, std::vector< Actor* >& result ) const
+	{
+		result.clear();
+
+		if( m_actorsByBucket.empty() )
+		{
+			return;
+		}
+
+		int cellX = getCellCoordinate( position.x );
+		int cellY = getCellCoordinate( position.y );
+
+		for( int offsetY = -1; offsetY <= 1; ++offsetY )
+		{
+			for( int offsetX = -1; offsetX <= 1; ++offsetX )
+			{
+				// Gather every Actor in this cell and the eight cells around it.
+				size_t bucket = getBucketIndex( cellX + offsetX, cellY + offsetY );
+				size_t begin = m_bucketStarts[ bucket ];
+				size_t end = m_bucketStarts[ bucket + 1 ];
+
+				result.insert( result.end(), m_actorsByBucket.begin() + begin, m_actorsByBucket.begin() + end );
+			}
+		}
+
+		// Neighboring cells may share a bucket, so sort the Actors by ID and remove duplicates.
+		std::sort( result.begin(), result.end(), []( const Actor* first, const Actor* second )
+		{
+			return ( first->getID() < second->getID() );
+		} );
+
+		result.erase( std::unique( result.begin(), result.end() ), result.end() );
+	}
+}
@@ -0,0 +1,168 @@
+#include "common.h"
+#include "ThreadPool.h"
+
+namespace atc
+{
+	// ------------------------------ ThreadPool ------------------------------
+
+	ThreadPool::ThreadPool() :
+		m_threadCount( std::max( std::thread::hardware_concurrency(), 1u ) ),
+		m_task( nullptr ),
+		m_taskGeneration( 0 ),
+		m_busyWorkerCount( 0 ),
+		m_isStopping( false )
+	{ }
+
+
+	ThreadPool::~ThreadPool()
+	{
+		stop();
+	}
+
+
+	void ThreadPool::run( const Task& task )
+	{
+		// Only one task runs at a time. Anyone else has to wait for it to finish.
+		std::lock_guard< std::mutex > runLock( m_runMutex );
+
+		// Start the worker threads the first time they are needed.
+		if( m_threadCount > 1 && !isRunning() )
+		{
+			start();
+		}
+
+		{
+			// Wake the workers up to run the task.
+			std::lock_guard< std::mutex > lock( m_mutex );
+			m_task = &task;
+			m_busyWorkerCount = m_threads.size();
+			++m_taskGeneration;
+			m_taskSubmitted.notify_all();
+		}
+
+		// Do a share of the work on this thread, too.
+		task( 0 );
+
+		// Wait for the workers to finish their shares.
+		std::unique_lock< std::mutex > lock( m_mutex );
+		m_taskFinished.wait( lock, [ this ] { return ( m_busyWorkerCount == 0 ); } );
+		m_task = nullptr;
+	}
+
+
+	void ThreadPool::stop()
+	{
+		if( isRunning() )
+		{
+			{
+				// Tell the threads to exit.
+				std::lock_guard< std::mutex > lock( m_mutex );
+				m_isStopping = true;
+				m_taskSubmitted.notify_all();
+			}
+
+			for( std::thread& thread : m_threads )
+			{
+				thread.join();
+			}
+
+			m_threads.clear();
+			m_isStopping = false;
+		}
+	}
+
+
+	void ThreadPool::setThreadCount( size_t threadCount )
+	{
+		requires( threadCount > 0 );
+
+		// Let any running task finish, then restart with the new number of threads when next needed.
+		std::lock_guard< std::mutex > runLock( m_runMutex );
+		stop();
+		m_threadCount = threadCount;
+	}
+
+
+	void ThreadPool::start()
+	{
+		requires( !isRunning() );
+
+		// The calling thread is thread 0, so only the others need to be started.
+		for( size_t i = 1; i < m_threadCount; ++i )
+		{
+			m_threads.push_back( std::thread( &ThreadPool::runWorker, this, i, m_taskGeneration ) );
+		}
+	}
+
+
+	void ThreadPool::runWorker( size_t threadIndex, size_t taskGeneration )
+	{
+		std::unique_lock< std::mutex > lock( m_mutex );
+
+		while( true )
+		{
+			// Sleep until there is a new task to run.
+			m_taskSubmitted.wait( lock, [ this, taskGeneration ] { return ( m_isStopping || m_taskGeneration != taskGeneration ); } );
+
+			if( m_isStopping )
+			{
+				break;
+			}
+
+			// Run this thread's share of the task without holding the lock.
+			taskGeneration = m_taskGeneration;
+			const Task* task = m_task;
+
+			lock.unlock();
+			( *task )( threadIndex );
+			lock.lock();
+
+			// Let the caller know once every share is finished.
+			if( --m_busyWorkerCount == 0 )
+			{
+				m_taskFinished.notify_all();
+			}
+		}
+	}
+
+
+	// ------------------------------ ThreadBarrier ------------------------------
+
+	const int ThreadBarrier::SPINS_BEFORE_YIELDING;
+
+
+	ThreadBarrier::ThreadBarrier( size_t threadCount ) :
+		m_threadCount( threadCount ),
+		m_waitingThreadCount( 0 ),
+		m_generation( 0 )
+	{
+		requires( threadCount > 0 );
+	}
+
+
+	ThreadBarrier::~ThreadBarrier() { }
+
+
+	void ThreadBarrier::wait()
+	{
+		size_t generation = m_generation.load( std::memory_order_acquire );
+
+		if( ( m_waitingThreadCount.fetch_add( 1, std::memory_order_acq_rel ) + 1 ) == m_threadCount )
+		{
+			// The last thread to arrive resets the barrier and lets everyone through.
+			m_waitingThreadCount.store( 0, std::memory_order_relaxed );
+			m_generation.fetch_add( 1, std::memory_order_release );
+		}
+		else
+		{
+			// Wait for the last thread, giving up the core if it takes a while.
+			for( int spins = 0; m_generation.load( std::memory_order_acquire ) == generation; ++spins )
+			{
+				if( spins >= SPINS_BEFORE_YIELDING )
+				{
+					std::this_thread::yield();
+				}
+			}
+		}
+	}
+}
@@ -120,14 +120,59 @@ namespace atc
 
 	void Unit::updateTargetLocation()
 	{
+		const Flowfield* flowfield = m_formation->getFlowfield();
+
 		// Get the current flowfield tile.
-		Flowfield* flowfield = m_formation->getFlowfield();
-		Flowfield::Tile currentFlowfieldTile = getWorld()->getFlowfieldTileAtPosition( flowfield, m_position );
+		Flowfield::ConstTile currentFlowfieldTile = getWorld()->getFlowfieldTileAtPosition( flowfield, m_position );
+
+		if( !flowfield->isTileFinal( currentFlowfieldTile ) )
+		{
+			// Until the flowfield has reached this Unit, head straight for the Formation if nothing
+			// is in the way, or hold position otherwise.
+			Point destination = ( hasFormationSlot() ? m_formation->getSlotWorldLocation( m_formationSlotIndex ) : m_formation->getOrigin() );
+			setTargetLocation( canMoveDirectlyTo( destination ) ? destination : m_position );
+			return;
+		}
+
+		if( currentFlowfieldTile->isGoal() && hasFormationSlot() )
+		{
+			// This Unit reached the footprint of its Formation at the destination, so head for its own slot there rather
+			// than piling onto the goal tile with the rest.
+			Point slotDestination = m_formation->getSlotDestination( m_formationSlotIndex );
+
+			if( canMoveDirectlyTo( slotDestination ) )
+			{
+				setTargetLocation( slotDestination );
+				return;
+			}
+		}
+
+		if( currentFlowfieldTile->isGoal() || flowfield->hasLineOfSight( currentFlowfieldTile, TRACE_RADIUS ) )
+		{
+			// The Flowfield found that nothing is in the way of the goal from here, so head straight for it without tracing.
+			// (The rest of a Formation's footprint is in view of the goal, so Units that reach it without a way to their
+			// slots carry on to the goal.)
+			setTargetLocation( getWorld()->getFlowfieldTileWorldPosition( flowfield->getGoalTile() ) );
+			return;
+		}
+
+		if( flowfield->hasVectorField() )
+		{
+			// Steer along the vector field, which bends smoothly around walls, rather than tracing ahead for a shortcut.
+			// Where the tiles around this Unit disagree too much to blend, there is no vector, so trace instead.
+			Vector direction = flowfield->sampleVectorField( m_position.x, m_position.y );
+
+			if( direction.getLengthSquared() > 0.0f )
+			{
+				setTargetLocation( m_position + direction );
+				return;
+			}
+		}
 
 		// Over several frames, trace out to the farthest tile that can be reached in a straight line.
-		Flowfield::Tile currentTargetTile = getWorld()->getFlowfieldTileAtPosition( flowfield, m_targetLocation );
+		Flowfield::ConstTile currentTargetTile = getWorld()->getFlowfieldTileAtPosition( flowfield, m_targetLocation );
 
-		if( ( currentTargetTile == currentFlowfieldTile ) || !canMoveDirectlyTo( m_targetLocation ) )
+		if( ( currentTargetTile == currentFlowfieldTile ) || !canMoveDirectlyTo( m_targetLocation ) || !flowfield->isTileFinal( currentTargetTile ) )
 		{
 			// Otherwise, start over at the best tile adjacent to this Unit's current Flowfield tile.
 			currentTargetTile = currentFlowfieldTile.getAdjacentTile( currentFlowfieldTile->getBestAdjacency() );
@@ -142,7 +187,7 @@ namespace atc
 
 			if( nextTileDirection != CARDINAL_DIRECTION_NONE )
 			{
-				Flowfield::Tile nextTile = currentTargetTile.getAdjacentTile( nextTileDirection );
+				Flowfield::ConstTile nextTile = currentTargetTile.getAdjacentTile( nextTileDirection );
 				Point nextTilePosition = getWorld()->getFlowfieldTileWorldPosition( nextTile );
 
 				if( canMoveDirectlyTo( nextTilePosition ) )
@@ -207,6 +252,7 @@ namespace atc
 	}
 
 
+#ifndef ATC_HEADLESS
 	void Unit::draw( Renderer* renderer )
 	{
 		// Draw the Unit's current path.
@@ -236,6 +282,7 @@ namespace atc
 
 		renderer->popTransform();
 	}
+#endif
 
 
 	void Unit::onCollision( Actor* other, const Vector& displacement, float collisionDistance )
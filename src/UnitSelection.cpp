@@ -18,6 +18,7 @@ namespace atc
 	}
 
 
+#ifndef ATC_HEADLESS
 	void UnitSelection::draw( Renderer* renderer )
 	{
 		glColor3f( 0.0f, 1.0f, 1.0f );
@@ -32,18 +33,24 @@ namespace atc
 			renderer->popTransform();
 		}
 	}
+#endif
 
 
 	void UnitSelection::orderMoveTo( const Point& destination )
 	{
 		Formation* formation = nullptr;
+		Point target = destination;
 
 		if( getUnitCount() >= 1 )
 		{
+			// Move as close as possible to a destination that none of the Units can reach (e.g. inside a walled-off area).
+			World* world = getUnitByIndex( 0 )->getWorld();
+			target = findReachableDestination( destination );
+
 			// If there are two or more units in this selection, create a new Formation at the center of mass.
 			// TODO: Get specific FormationBehavior type from current formation settings.
 			Point centerOfMass = calculateCenterOfMass();
-			formation = g_app.getWorld()->createFormation( centerOfMass, destination, new BoxFormationBehavior( 1.0f ) );
+			formation = world->createFormation( centerOfMass, target, new BoxFormationBehavior( 1.0f ) );
 		}
 
 		for( auto it = m_unitsByID.begin(); it != m_unitsByID.end(); ++it )
@@ -63,11 +70,60 @@ namespace atc
 			}
 
 			// Let the Unit handle the order.
-			unit->orderMoveTo( destination );
+			unit->orderMoveTo( target );
 		}
 	}
 
 
+	Point UnitSelection::findReachableDestination( const Point& destination ) const
+	{
+		requires( getUnitCount() >= 1 );
+
+		World* world = getUnitByIndex( 0 )->getWorld();
+		Map* map = world->getMap();
+		Map::TileVector goalPosition = world->worldToTileCoords( destination );
+		Point result = destination;
+
+		if( map->contains( goalPosition ) )
+		{
+			bool isReachable = false;
+			bool hasStartPosition = false;
+			Map::TileVector startPosition;
+
+			for( auto it = m_unitsByID.begin(); it != m_unitsByID.end() && !isReachable; ++it )
+			{
+				Map::TileVector position = world->worldToTileCoords( it->second->getPosition() );
+
+				if( map->contains( position ) )
+				{
+					// Keep the destination if any of the Units can reach it. The Map knows which areas are connected,
+					// so this doesn't search.
+					isReachable = map->isReachable( position, goalPosition );
+
+					if( !hasStartPosition )
+					{
+						startPosition = position;
+						hasStartPosition = true;
+					}
+				}
+			}
+
+			if( !isReachable && hasStartPosition )
+			{
+				// Otherwise, head for the nearest tile the first Unit can reach.
+				Map::TileVector nearestPosition = map->findNearestReachableTile( startPosition, goalPosition );
+
+				if( nearestPosition != goalPosition )
+				{
+					result = world->tileToWorldCoords( nearestPosition );
+				}
+			}
+		}
+
+		return result;
+	}
+
+
 	Point UnitSelection::calculateCenterOfMass() const
 	{
 		Point sumOfPositions = Point::ZERO;
@@ -239,6 +239,14 @@ namespace atc
 			toggleTrace();
 			break;
 
+		case GLFW_KEY_C:
+			toggleCrowdDensity();
+			break;
+
+		case GLFW_KEY_O:
+			toggleOctileFlowfields();
+			break;
+
 		case GLFW_KEY_P:
 			g_app.togglePaused();
 			break;
@@ -267,4 +275,20 @@ namespace atc
 			world->endTrace();
 		}
 	}
+
+
+	void Window::toggleCrowdDensity()
+	{
+		// Let crowds steer flowfields around the places they jam (or stop letting them).
+		Map* map = g_app.getWorld()->getMap();
+		map->setCrowdDensityEnabled( !map->isCrowdDensityEnabled() );
+	}
+
+
+	void Window::toggleOctileFlowfields()
+	{
+		// Let Units cut diagonally across open ground (or go back to four-way flowfields).
+		Map* map = g_app.getWorld()->getMap();
+		map->setOctileFlowfieldsEnabled( !map->areOctileFlowfieldsEnabled() );
+	}
 }
\ No newline at end of file
@@ -6,6 +6,7 @@ namespace atc
 {
 	const char* World::MAP_FOLDER_PATH = "data/maps/";
 	const char* World::MAP_FILE_EXTENSION = ".png";
+	const char* World::FLOWFIELD_CACHE_FOLDER_PATH = "data/flowfields/";
 
 
 	World::World() :
@@ -38,6 +39,7 @@ namespace atc
 			// Resize the map.
 			m_map.resize( width, height );
 			m_map.clear();
+			m_markedGoals.clear();
 
 			for( int y = 0; y < height; ++y )
 			{
@@ -57,21 +59,44 @@ namespace atc
 					case 0xFF00FF00:
 						spawnUnit( Point( (float) x, (float) y ) );
 						break;
+
+					// Interpret blue pixels as goals, whose flowfields are worth baking ahead of time.
+					case 0xFFFF0000:
+						m_markedGoals.push_back( Map::TileVector( x, y ) );
+						break;
+
+					// Interpret shades of gray as terrain that costs more to cross the lighter it is, from
+					// black (open ground, or roads) to nearly white (e.g. mud or forest).
+					default:
+						unsigned int red = ( texel & 0xFF );
+
+						if( red == ( ( texel >> 8 ) & 0xFF ) && red == ( ( texel >> 16 ) & 0xFF ) )
+						{
+							m_map.getTile( x, y )->setTerrainCost( MapTile::MIN_COST + ( red * ( MapTile::MAX_COST - MapTile::MIN_COST ) + 127 ) / 254 );
+						}
+						break;
 					}
 				}
 			}
 
 			// Free the image data.
 			stbi_image_free( texels );
+
+			// Label the areas Units can move between, and how much room there is around each tile, now rather than
+			// on the first order.
+			m_map.findComponents();
+			m_map.findClearances();
 		}
 	}
 
 
 	void World::init()
 	{
+#ifndef ATC_HEADLESS
 		// Spawn a default camera and make it current.
 		Camera* defaultCamera = spawnDefaultCamera();
 		setCamera( defaultCamera );
+#endif
 	}
 
 
@@ -153,39 +178,182 @@ namespace atc
 
 	void World::update( double elapsedTime )
 	{
+		typedef std::chrono::steady_clock Clock;
+		typedef std::chrono::duration< double > Seconds;
+
+		Clock::time_point phaseStart = Clock::now();
+		Clock::time_point phaseEnd;
+		bool isTrackingCrowds = m_map.isCrowdDensityEnabled();
+
+		if( isTrackingCrowds )
+		{
+			// Note where each Actor starts out, to tell how far it really gets this tick.
+			recordCrowdPositions();
+		}
+
+		phaseEnd = Clock::now();
+		m_lastUpdateProfile.crowdTime = Seconds( phaseEnd - phaseStart ).count();
+		phaseStart = phaseEnd;
+
 		// Update the Map.
 		m_map.update( elapsedTime );
 
+		phaseEnd = Clock::now();
+		m_lastUpdateProfile.mapTime = Seconds( phaseEnd - phaseStart ).count();
+		phaseStart = phaseEnd;
+
+		// Update all Formations.
+		updateFormations( elapsedTime );
+
+		phaseEnd = Clock::now();
+		m_lastUpdateProfile.formationTime = Seconds( phaseEnd - phaseStart ).count();
+		phaseStart = phaseEnd;
+
+		// Update all Actors.
+		updateActors( elapsedTime );
+
+		phaseEnd = Clock::now();
+		m_lastUpdateProfile.actorTime = Seconds( phaseEnd - phaseStart ).count();
+		phaseStart = phaseEnd;
+
+		// Resolve collisions between Actors.
+		collideActors();
+
+		phaseEnd = Clock::now();
+		m_lastUpdateProfile.collisionTime = Seconds( phaseEnd - phaseStart ).count();
+		phaseStart = phaseEnd;
+
+		// Collide with walls.
+		collideActorsWithWalls();
+
+		phaseEnd = Clock::now();
+		m_lastUpdateProfile.wallCollisionTime = Seconds( phaseEnd - phaseStart ).count();
+		phaseStart = phaseEnd;
+
+		if( isTrackingCrowds )
+		{
+			// Splat the Actors into the Map's CrowdDensity, where they ended up after colliding.
+			splatCrowd( elapsedTime );
+		}
+
+		phaseEnd = Clock::now();
+		m_lastUpdateProfile.crowdTime += Seconds( phaseEnd - phaseStart ).count();
+		phaseStart = phaseEnd;
+
+		// Destroy removed Actors.
+		destroyRemovedActors();
+
+		// Destroy empty formations.
+		destroyEmptyFormations();
+
+		phaseEnd = Clock::now();
+		m_lastUpdateProfile.cleanupTime = Seconds( phaseEnd - phaseStart ).count();
+	}
+
+
+	void World::updateFormations( double elapsedTime )
+	{
 		for( auto it = m_formationsByIndex.begin(); it != m_formationsByIndex.end(); ++it )
 		{
 			// Update all Formations.
 			it->second->update( elapsedTime );
 		}
+	}
 
+
+	void World::updateActors( double elapsedTime )
+	{
 		for( auto it = m_actorsByID.begin(); it != m_actorsByID.end(); ++it )
 		{
 			// Update all actors.
 			it->second->update( elapsedTime );
 		}
+	}
+
+
+	void World::recordCrowdPositions()
+	{
+		m_crowdActors.clear();
+		m_crowdStartPositions.clear();
+
+		for( auto it = m_actorsByID.begin(); it != m_actorsByID.end(); ++it )
+		{
+			// Only Actors that collide can get in each other's way.
+			Actor* actor = it->second;
+
+			if( actor->isCollisionEnabled() )
+			{
+				m_crowdActors.push_back( actor );
+				m_crowdStartPositions.push_back( actor->getPosition() );
+			}
+		}
+	}
+
+
+	void World::splatCrowd( double elapsedTime )
+	{
+		CrowdDensity* crowdDensity = m_map.getCrowdDensity();
+		crowdDensity->clearUnits();
+
+		// Units clear their velocity at the end of each update, and collisions push them around
+		// besides, so use how far each one actually moved.
+		float inverseElapsedTime = ( elapsedTime > 0.0 ? (float) ( 1.0 / elapsedTime ) : 0.0f );
+
+		for( size_t i = 0; i < m_crowdActors.size(); ++i )
+		{
+			Point position = m_crowdActors[ i ]->getPosition();
+			crowdDensity->addUnit( position, ( position - m_crowdStartPositions[ i ] ) * inverseElapsedTime );
+		}
+
+		crowdDensity->update( elapsedTime );
+	}
+
 
-		for( auto first = m_actorsByID.begin(); first != m_actorsByID.end(); ++first )
+	void World::collideActors()
+	{
+		// Gather every Actor with collision enabled (in order of ID) and where it starts, along with the largest
+		// collision radius.
+		m_collidableActors.clear();
+		m_collidableStartPositions.clear();
+		float maxCollisionRadius = 0.0f;
+
+		for( auto it = m_actorsByID.begin(); it != m_actorsByID.end(); ++it )
 		{
-			Actor* firstActor = first->second;
+			Actor* actor = it->second;
 
-			if( !firstActor->isCollisionEnabled() )
+			if( actor->isCollisionEnabled() )
 			{
-				// Don't let Actors without collision collide with each other.
-				continue;
+				m_collidableActors.push_back( actor );
+				m_collidableStartPositions.push_back( actor->getPosition() );
+				maxCollisionRadius = std::max( maxCollisionRadius, actor->getCollisionRadius() );
 			}
+		}
 
-			for( auto second = first; second != m_actorsByID.end(); ++second )
+		if( m_collidableActors.size() < 2 || maxCollisionRadius <= 0.0f )
+		{
+			// If no two Actors can overlap, there's nothing to do.
+			return;
+		}
+
+		// Bucket the Actors into cells as wide as the largest collision diameter, so that
+		// any two overlapping Actors are in the same or neighboring cells.
+		m_actorHash.rebuild( m_collidableActors, ( maxCollisionRadius * 2.0f ) );
+
+		for( size_t firstIndex = 0; firstIndex < m_collidableActors.size(); ++firstIndex )
+		{
+			Actor* firstActor = m_collidableActors[ firstIndex ];
+
+			// Only test the Actors near this one. Look around where it was bucketed rather than where earlier
+			// collisions nudged it, so that it finds every Actor that was in a neighboring cell.
+			m_actorHash.findNearbyActors( m_collidableStartPositions[ firstIndex ], m_nearbyActors );
+
+			for( auto second = m_nearbyActors.begin(); second != m_nearbyActors.end(); ++second )
 			{
-				Actor* secondActor = second->second;
+				Actor* secondActor = ( *second );
 
-				if( firstActor == secondActor || !secondActor->isCollisionEnabled() )
+				if( secondActor->getID() <= firstActor->getID() )
 				{
-					// Don't let Actors without collision collide with each other,
-					// and don't let actors collide with themselves.
+					// Test each pair of Actors only once, and don't let actors collide with themselves.
 					continue;
 				}
 
@@ -212,21 +380,20 @@ namespace atc
 				}
 			}
 		}
+	}
+
 
+	void World::collideActorsWithWalls()
+	{
 		for( auto it = m_actorsByID.begin(); it != m_actorsByID.end(); ++it )
 		{
 			// Collide with walls.
 			it->second->collideWithWalls();
 		}
-
-		// Destroy removed Actors.
-		destroyRemovedActors();
-
-		// Destroy empty formations.
-		destroyEmptyFormations();
 	}
 
 
+#ifndef ATC_HEADLESS
 	void World::draw( Renderer* renderer )
 	{
 		// Apply the current camera (if any).
@@ -288,9 +455,9 @@ namespace atc
 		{
 			Formation* formation = ( *it );
 
-			if( formation->hasFlowfield() )
+			if( formation->hasFlowfield() && formation->getFlowfield()->isReady() )
 			{
-				Flowfield* flowfield = formation->getFlowfield();
+				const Flowfield* flowfield = formation->getFlowfield();
 				drawFlowfield( flowfield, renderer, formation->getColor(), tileLeft, tileBottom, tileRight, tileTop );
 			}
 		}
@@ -321,7 +488,7 @@ namespace atc
 		if( m_isTracing )
 		{
 			// Update the trace destination.
-			m_traceDestination = g_app.getWorld()->getMouseWorldPosition();
+			m_traceDestination = getMouseWorldPosition();
 
 			// Trace the intercepts between both points.
 			std::vector< Point > intercepts;
@@ -366,6 +533,16 @@ namespace atc
 
 				if( tile->isPassable() )
 				{
+					if( tile->getTerrainCost() > MapTile::MIN_COST || tile->getCongestionCost() > 0 )
+					{
+						// Shade terrain that costs more to cross, lighter the more it costs (as in the map image),
+						// and tint it red where crowds have made it cost more.
+						float shade = ( 0.4f * ( tile->getTerrainCost() - MapTile::MIN_COST ) / ( MapTile::MAX_COST - MapTile::MIN_COST ) );
+						float congestion = ( 0.4f * tile->getCongestionCost() / CrowdDensity::MAX_CONGESTION_COST );
+						glColor3f( shade + congestion, shade, shade );
+						renderer->fillRectangle( bottomLeft, topRight );
+					}
+
 					glColor3f( 0.1f, 0.15f, 0.25f );
 					renderer->drawRectangle( bottomLeft, topRight );
 				}
@@ -379,7 +556,7 @@ namespace atc
 	}
 
 
-	void World::drawFlowfield( Flowfield* flowfield, Renderer* renderer, Color color, short tileLeft, short tileBottom, short tileRight, short tileTop )
+	void World::drawFlowfield( const Flowfield* flowfield, Renderer* renderer, Color color, short tileLeft, short tileBottom, short tileRight, short tileTop )
 	{
 		requires( flowfield );
 		requires( renderer );
@@ -392,16 +569,22 @@ namespace atc
 
 		float alphaScale = ( 255.0f / ( width + height ) );
 
+		if( flowfield->isOctile() )
+		{
+			// Octile distances count each straight step several times over.
+			alphaScale /= Flowfield::OCTILE_STRAIGHT_STEP_COST;
+		}
+
 		for( unsigned int y = tileBottom; y <= tileTop; ++y )
 		{
 			for( unsigned int x = tileLeft; x <= tileRight; ++x )
 			{
 				// Get the tile to draw.
-				Flowfield::Tile tile = flowfield->getTile( x, y );
+				Flowfield::ConstTile tile = flowfield->getTile( x, y );
 
 				// Adjust the opacity of the color based on cost.
 				Color tileColor = color;
-				tileColor.alpha = (unsigned char) std::min( tile->getDistanceToGoal() * alphaScale, 255.0f );
+				tileColor.alpha = (unsigned char) std::min( flowfield->getDistanceToGoal( tile ) * alphaScale, 255.0f );
 
 				// Draw the tile.
 				renderer->setColor( tileColor );
@@ -429,7 +612,7 @@ namespace atc
 					renderer->popTransform();
 				}
 
-				CardinalDirection bestAdjacentTileDirection = tile->getAdjacency( 0 );
+				CardinalDirection bestAdjacentTileDirection = tile->getBestAdjacency();
 
 				if( bestAdjacentTileDirection != CARDINAL_DIRECTION_NONE )
 				{
@@ -452,6 +635,22 @@ namespace atc
 					case CARDINAL_DIRECTION_SOUTH:
 						endpoint.y += 0.5f;
 						break;
+
+					case CARDINAL_DIRECTION_NORTHEAST:
+						endpoint += Vector( 0.5f, -0.5f );
+						break;
+
+					case CARDINAL_DIRECTION_NORTHWEST:
+						endpoint += Vector( -0.5f, -0.5f );
+						break;
+
+					case CARDINAL_DIRECTION_SOUTHWEST:
+						endpoint += Vector( -0.5f, 0.5f );
+						break;
+
+					case CARDINAL_DIRECTION_SOUTHEAST:
+						endpoint += Vector( 0.5f, 0.5f );
+						break;
 					}
 
 					renderer->pushTransform( Vector( (float) x, (float) y ) );
@@ -479,6 +678,7 @@ namespace atc
 
 		return camera;
 	}
+#endif
 
 
 	Unit* World::spawnUnit( const Point& location )
@@ -493,11 +693,13 @@ namespace atc
 	}
 
 
+#ifndef ATC_HEADLESS
 	Point World::getMouseWorldPosition() const
 	{
 		requires( m_camera );
 		return m_camera->deviceToWorldCoords( g_app.getWindow()->getMousePosition() );
 	}
+#endif
 
 
 	Unit* World::getUnitAtLocation( const Point& location ) const
@@ -711,29 +913,13 @@ namespace atc
 	{
 		requires( radius >= 0.0f );
 
-		bool result = true;
-
-		// Get the bounds of the area to check.
+		// Get the bounds of the area to check. The Map knows how much room there is around each tile, so this
+		// doesn't need to visit every tile in the area.
 		Vector radiusOffset( radius, radius );
 		Map::TileVector minBounds = worldToTileCoords( position - radiusOffset );
 		Map::TileVector maxBounds = worldToTileCoords( position + radiusOffset );
 
-		for( short y = minBounds.y; y <= maxBounds.y; ++y )
-		{
-			for( short x = minBounds.x; x <= maxBounds.x; ++x )
-			{
-				Map::ConstTile tile = m_map.getTile( x, y );
-
-				if( !( tile.isValid() && tile->isPassable() ) )
-				{
-					// If any tile is not passable or valid, return false.
-					result = false;
-					break;
-				}
-			}
-		}
-
-		return result;
+		return m_map.isAreaPassable( minBounds, maxBounds );
 	}
 
 
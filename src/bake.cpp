@@ -0,0 +1,81 @@
+#include "common.h"
+
+#include <chrono>
+
+using namespace atc;
+
+
+int main( int argc, char** argv )
+{
+	if( argc < 2 )
+	{
+		std::cout << "usage: " << argv[ 0 ] << " <map> [--octile] [x y]..." << std::endl;
+		return 1;
+	}
+
+	// Load the map, without setting up the World around it.
+	std::string mapName = argv[ 1 ];
+	World* world = new World();
+	world->loadMap( mapName );
+
+	Map* map = world->getMap();
+	map->setFlowfieldCacheFolder( World::FLOWFIELD_CACHE_FOLDER_PATH );
+
+	// Bake the goals marked on the map, and any others given on the command line.
+	std::vector< Map::TileVector > goals = world->getMarkedGoals();
+	bool isOctile = false;
+
+	for( int i = 2; i < argc; ++i )
+	{
+		if( strcmp( argv[ i ], "--octile" ) == 0 )
+		{
+			isOctile = true;
+		}
+		else if( ( i + 1 ) < argc )
+		{
+			goals.push_back( Map::TileVector( (Map::TileOffset) atoi( argv[ i ] ), (Map::TileOffset) atoi( argv[ i + 1 ] ) ) );
+			++i;
+		}
+	}
+
+	int result = 0;
+
+	for( const Map::TileVector& goal : goals )
+	{
+		if( !map->contains( goal ) || !map->getTile( goal )->isPassable() )
+		{
+			std::cout << "skipping " << goal.x << "," << goal.y << ": not a passable tile" << std::endl;
+			continue;
+		}
+
+		// Build the whole flowfield (never hierarchical), as the Map would load it.
+		auto startTime = std::chrono::steady_clock::now();
+		Flowfield* flowfield = map->createFlowfield();
+		flowfield->setGoalTile( flowfield->getTile( goal.x, goal.y ) );
+		flowfield->setOctile( isOctile );
+		flowfield->recalculate();
+		auto endTime = std::chrono::steady_clock::now();
+
+		std::string path = map->getFlowfieldCachePath( goal, std::vector< Flowfield::TileVector >(), isOctile );
+
+		if( flowfield->saveToFile( path ) )
+		{
+			std::cout << "baked " << path << " in " << std::chrono::duration< double, std::milli >( endTime - startTime ).count() << " ms" << std::endl;
+		}
+		else
+		{
+			std::cout << "failed to write " << path << std::endl;
+			result = 1;
+		}
+
+		map->destroyFlowfield( flowfield );
+	}
+
+	if( goals.empty() )
+	{
+		std::cout << "map " << mapName << " has no marked goals, and none were given" << std::endl;
+	}
+
+	delete world;
+	return result;
+}
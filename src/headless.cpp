@@ -0,0 +1,53 @@
+#include "common.h"
+
+#include <chrono>
+
+using namespace atc;
+
+
+int main( int argc, char** argv )
+{
+	// Read the map name, the number of ticks to simulate, and the (optional) destination.
+	std::string mapName = ( argc > 1 ? argv[ 1 ] : "04" );
+	int tickCount = ( argc > 2 ? atoi( argv[ 2 ] ) : 1000 );
+
+	// Set up the World and load the map.
+	World* world = new World();
+	world->loadMap( mapName );
+	world->init();
+
+	Point destination( world->getRight() * 0.5f, world->getTop() * 0.5f );
+
+	if( argc > 4 )
+	{
+		destination = Point( (float) atof( argv[ 3 ] ), (float) atof( argv[ 4 ] ) );
+	}
+
+	// Select every Unit on the map and order them all to the destination.
+	UnitSelection selection;
+	world->getAllUnitsInArea( Point( world->getLeft(), world->getBottom() ), Point( world->getRight(), world->getTop() ), selection );
+	selection.orderMoveTo( destination );
+
+	// The Formation lays out its slots and requests its flowfield on the first tick, and flowfields are
+	// built in the background. Wait for them after that tick, so every run simulates the same ticks.
+	world->update( TARGET_FRAME_TIME );
+	world->getMap()->waitForFlowfields();
+
+	auto startTime = std::chrono::steady_clock::now();
+
+	for( int i = 0; i < tickCount; ++i )
+	{
+		// Step the simulation at the same fixed rate as the app.
+		world->update( TARGET_FRAME_TIME );
+	}
+
+	auto endTime = std::chrono::steady_clock::now();
+	double elapsedSeconds = std::chrono::duration< double >( endTime - startTime ).count();
+
+	std::cout << "map " << mapName << ": " << selection.getUnitCount() << " units, "
+			  << tickCount << " ticks in " << elapsedSeconds << " s ("
+			  << ( tickCount / std::max( elapsedSeconds, 1e-9 ) ) << " ticks/s)" << std::endl;
+
+	delete world;
+	return 0;
+}